@@ -7,8 +7,16 @@
 
 namespace nyan {
 
+std::atomic<bool> APIError::generate_backtrace = true;
+
+
 APIError::APIError(const std::string &msg) :
-	Error{msg} {}
+	Error{msg, APIError::generate_backtrace.load(std::memory_order_relaxed)} {}
+
+
+void APIError::enable_backtrace(bool enable) {
+	APIError::generate_backtrace.store(enable, std::memory_order_relaxed);
+}
 
 
 InvalidObjectError::InvalidObjectError() :
@@ -1,6 +1,8 @@
 // Copyright 2019-2021 the nyan authors, LGPLv3+. See copying.md for legal info.
 #pragma once
 
+#include <atomic>
+
 #include "error.h"
 
 
@@ -12,6 +14,22 @@ namespace nyan {
 class APIError : public Error {
 public:
 	APIError(const std::string &msg);
+
+	/**
+	 * Enable collecting a backtrace when an APIError is constructed.
+	 * Enabled by default. Disable it if API errors are part of the
+	 * normal control flow, e.g. when probing for optional members,
+	 * since walking the stack dominates the cost of the throw.
+	 *
+	 * @param enable If true, collect backtraces, else don't.
+	 */
+	static void enable_backtrace(bool enable);
+
+protected:
+	/**
+	 * Collect a backtrace when an APIError is constructed.
+	 */
+	static std::atomic<bool> generate_backtrace;
 };
 
 
@@ -73,22 +73,29 @@ std::string ASTBase::str() const {
 }
 
 
-const std::vector<ASTArgument> &AST::get_args() const {
+const std::pmr::vector<ASTArgument> &AST::get_args() const {
 	return this->args;
 }
 
 
-const std::vector<ASTObject> &AST::get_objects() const {
+const std::pmr::vector<ASTObject> &AST::get_objects() const {
 	return this->objects;
 }
 
 
-const std::vector<ASTImport> &AST::get_imports() const {
+const std::pmr::vector<ASTImport> &AST::get_imports() const {
 	return this->imports;
 }
 
 
-AST::AST(TokenStream &tokens) {
+AST::AST(const std::shared_ptr<File> &file,
+         std::unique_ptr<std::pmr::memory_resource> &&arena,
+         TokenStream &tokens) :
+	arena{std::move(arena)},
+	args{tokens.get_resource()},
+	imports{tokens.get_resource()},
+	objects{tokens.get_resource()},
+	file{file} {
 	auto token = tokens.next();
 
 	// Ensure that AST has version argument
@@ -131,7 +138,9 @@ AST::AST(TokenStream &tokens) {
 }
 
 
-ASTArgument::ASTArgument(TokenStream &tokens) {
+ASTArgument::ASTArgument(TokenStream &tokens) :
+	arg{tokens.get_resource()},
+	params{tokens.get_resource()} {
 	auto token = tokens.next();
 
 	if (token->type == token_type::ID) {
@@ -159,12 +168,13 @@ const IDToken &ASTArgument::get_arg() const {
 }
 
 
-const std::vector<IDToken> &ASTArgument::get_params() const {
+const std::pmr::vector<IDToken> &ASTArgument::get_params() const {
 	return this->params;
 }
 
 
-ASTImport::ASTImport(TokenStream &tokens) {
+ASTImport::ASTImport(TokenStream &tokens) :
+	namespace_name{tokens.get_resource()} {
 	auto token = tokens.next();
 
 	if (token->type == token_type::ID) {
@@ -207,7 +217,12 @@ const Token &ASTImport::get_alias() const {
 
 ASTObject::ASTObject(const Token &name,
                      TokenStream &tokens) :
-	name{name} {
+	name{name},
+	target{tokens.get_resource()},
+	inheritance_change{tokens.get_resource()},
+	parents{tokens.get_resource()},
+	members{tokens.get_resource()},
+	objects{tokens.get_resource()} {
 	auto token = tokens.next();
 
 	if (token->type == token_type::LANGLE) {
@@ -353,12 +368,13 @@ const Token &ASTObject::get_name() const {
 }
 
 
-const std::vector<ASTObject> &ASTObject::get_objects() const {
+const std::pmr::vector<ASTObject> &ASTObject::get_objects() const {
 	return this->objects;
 }
 
 
-ASTInheritanceChange::ASTInheritanceChange(TokenStream &tokens) {
+ASTInheritanceChange::ASTInheritanceChange(TokenStream &tokens) :
+	target{tokens.get_resource()} {
 	bool had_operator = false;
 	bool had_target = false;
 	auto token = tokens.next();
@@ -509,7 +525,7 @@ ASTMember::ASTMember(const Token &name,
 					throw ASTError{"expected value, have", *token};
 				}
 
-				this->value = ASTMemberValue{IDToken{*token, tokens}};
+				this->value = ASTMemberValue{IDToken{*token, tokens}, tokens.get_resource()};
 			}
 		}
 
@@ -532,7 +548,9 @@ ASTMember::ASTMember(const Token &name,
 
 ASTMemberType::ASTMemberType(const Token &name,
                              TokenStream &tokens) :
-	name{IDToken{name, tokens}} {
+	name{IDToken{name, tokens}},
+	nested_types{tokens.get_resource()},
+	args{tokens.get_resource()} {
 	// now there may follow type arguments, e.g.:
 	// set(arg, key=val)
 	// optional(dict(ktype, vtype))
@@ -588,7 +606,8 @@ ASTMemberType::ASTMemberType(const Token &name,
 }
 
 
-ASTMemberTypeArgument::ASTMemberTypeArgument(TokenStream &tokens) {
+ASTMemberTypeArgument::ASTMemberTypeArgument(TokenStream &tokens) :
+	value{tokens.get_resource()} {
 	auto token = tokens.next();
 	if (token->type != token_type::ID) {
 		throw ASTError("expected argument value or key, but got", *token);
@@ -616,15 +635,18 @@ ASTMemberTypeArgument::ASTMemberTypeArgument(TokenStream &tokens) {
 }
 
 
-ASTMemberValue::ASTMemberValue(const IDToken &value) :
-	composite_type{composite_t::SINGLE} {
-	this->values.emplace_back(value);
+ASTMemberValue::ASTMemberValue(const IDToken &value,
+                               std::pmr::memory_resource *resource) :
+	composite_type{composite_t::SINGLE},
+	values{resource} {
+	this->values.emplace_back(value, resource);
 }
 
 
 ASTMemberValue::ASTMemberValue(composite_t type,
                                TokenStream &tokens) :
-	composite_type{type} {
+	composite_type{type},
+	values{tokens.get_resource()} {
 	token_type end_token;
 
 	switch (this->composite_type) {
@@ -636,8 +658,7 @@ ASTMemberValue::ASTMemberValue(composite_t type,
 			end_token,
 			tokens,
 			[this](const Token &token, TokenStream &stream) {
-				const IDToken id_token = IDToken(token, stream);
-				this->values.emplace_back(id_token);
+				this->values.emplace_back(IDToken{token, stream}, stream.get_resource());
 			});
 	} break;
 	case composite_t::DICT: {
@@ -647,7 +668,7 @@ ASTMemberValue::ASTMemberValue(composite_t type,
 			end_token,
 			tokens,
 			[this](const Token &token, TokenStream &stream) {
-				std::vector<IDToken> id_tokens;
+				std::pmr::vector<IDToken> id_tokens{stream.get_resource()};
 
 				// key
 				id_tokens.emplace_back(token, stream);
@@ -663,7 +684,7 @@ ASTMemberValue::ASTMemberValue(composite_t type,
 				// value
 				id_tokens.emplace_back(*next_token, stream);
 
-				this->values.emplace_back(composite_type, id_tokens);
+				this->values.emplace_back(composite_type, std::move(id_tokens));
 			});
 	} break;
 
@@ -673,7 +694,7 @@ ASTMemberValue::ASTMemberValue(composite_t type,
 }
 
 
-const std::vector<ValueToken> &ASTMemberValue::get_values() const {
+const std::pmr::vector<ValueToken> &ASTMemberValue::get_values() const {
 	return this->values;
 }
 
@@ -3,6 +3,7 @@
 
 
 #include <memory>
+#include <memory_resource>
 #include <optional>
 #include <sstream>
 #include <string>
@@ -133,12 +134,12 @@ protected:
 	/**
 	 * Nested types of a composite type member, e.g. int in set(int)
 	 */
-	std::vector<ASTMemberType> nested_types;
+	std::pmr::vector<ASTMemberType> nested_types;
 
 	/**
 	 * Type arguments.
 	 */
-	std::vector<ASTMemberTypeArgument> args;
+	std::pmr::vector<ASTMemberTypeArgument> args;
 };
 
 
@@ -152,14 +153,15 @@ class ASTMemberValue : public ASTBase {
 public:
 	ASTMemberValue(composite_t type,
 	               TokenStream &tokens);
-	ASTMemberValue(const IDToken &value);
+	ASTMemberValue(const IDToken &value,
+	               std::pmr::memory_resource *resource);
 
 	/**
 	 * Returns the values defined by this member value.
 	 *
 	 * @return A list of ValueToken objects that each contain a subvalue.
 	 */
-	const std::vector<ValueToken> &get_values() const;
+	const std::pmr::vector<ValueToken> &get_values() const;
 
 	/**
 	 * Returns the composite type of the member value.
@@ -179,7 +181,7 @@ protected:
 	/**
 	 * Values defined in the member value.
 	 */
-	std::vector<ValueToken> values;
+	std::pmr::vector<ValueToken> values;
 };
 
 
@@ -238,11 +240,11 @@ public:
 	 *
 	 * @return A list of IDTokens with argument parameter values.
 	 */
-	const std::vector<IDToken> &get_params() const;
+	const std::pmr::vector<IDToken> &get_params() const;
 
 protected:
 	IDToken arg;
-	std::vector<IDToken> params;
+	std::pmr::vector<IDToken> params;
 };
 
 
@@ -381,7 +383,7 @@ public:
 	 *
 	 * @return A list of nested ASTObjects.
 	 */
-	const std::vector<ASTObject> &get_objects() const;
+	const std::pmr::vector<ASTObject> &get_objects() const;
 
 	void strb(std::ostringstream &builder, int indentlevel = 0) const override;
 
@@ -399,31 +401,51 @@ protected:
 	/**
 	 * Inheritance changes to the target if this is a patch.
 	 */
-	std::vector<ASTInheritanceChange> inheritance_change;
+	std::pmr::vector<ASTInheritanceChange> inheritance_change;
 
 	/**
 	 * Parents of the object.
 	 */
-	std::vector<IDToken> parents;
+	std::pmr::vector<IDToken> parents;
 
 	/**
 	 * Members of the object.
 	 */
-	std::vector<ASTMember> members;
+	std::pmr::vector<ASTMember> members;
 
 	/**
 	 * Nested objects in the object.
 	 */
-	std::vector<ASTObject> objects;
+	std::pmr::vector<ASTObject> objects;
 };
 
 
 /**
  * Abstract syntax tree root.
+ *
+ * All nodes of the tree allocate from the memory resource of the
+ * TokenStream it was created from, usually an arena owned by the AST.
+ * Then the whole tree is built and freed with a few large allocations.
  */
 class AST : public ASTBase {
 public:
-	AST(TokenStream &tokens);
+	/**
+	 * Create the AST of a file.
+	 *
+	 * @param file File the tokens were read from.
+	 * @param arena Memory resource of the token stream, owned by the AST from now on.
+	 *     nullptr if the resource is owned elsewhere.
+	 * @param tokens TokenStream of the file.
+	 */
+	AST(const std::shared_ptr<File> &file,
+	    std::unique_ptr<std::pmr::memory_resource> &&arena,
+	    TokenStream &tokens);
+
+	// moving the nodes between arenas would copy them.
+	AST(AST &&other) noexcept = default;
+	AST &operator=(AST &&other) = delete;
+	AST(const AST &other) = delete;
+	AST &operator=(const AST &other) = delete;
 
 	void strb(std::ostringstream &builder, int indentlevel = 0) const override;
 
@@ -432,37 +454,49 @@ public:
 	 *
 	 * @return A list of ASTArguments.
 	 */
-	const std::vector<ASTArgument> &get_args() const;
+	const std::pmr::vector<ASTArgument> &get_args() const;
 
 	/**
 	 * Returns the imports in the AST.
 	 *
 	 * @return A list of ASTImports.
 	 */
-	const std::vector<ASTImport> &get_imports() const;
+	const std::pmr::vector<ASTImport> &get_imports() const;
 
 	/**
 	 * Returns the objects in the AST.
 	 *
 	 * @return A list of ASTObjects.
 	 */
-	const std::vector<ASTObject> &get_objects() const;
+	const std::pmr::vector<ASTObject> &get_objects() const;
 
 protected:
+	/**
+	 * Memory for the nodes of the AST.
+	 * Declared first so it is destroyed after the nodes.
+	 */
+	std::unique_ptr<std::pmr::memory_resource> arena;
+
 	/**
 	 * Arguments in the AST.
 	 */
-	std::vector<ASTArgument> args;
+	std::pmr::vector<ASTArgument> args;
 
 	/**
 	 * Imports in the AST.
 	 */
-	std::vector<ASTImport> imports;
+	std::pmr::vector<ASTImport> imports;
 
 	/**
 	 * Objects in the AST.
 	 */
-	std::vector<ASTObject> objects;
+	std::pmr::vector<ASTObject> objects;
+
+	/**
+	 * File the AST was created from.
+	 * The tokens in the AST refer to its content.
+	 */
+	std::shared_ptr<File> file;
 };
 
 
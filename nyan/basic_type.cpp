@@ -148,20 +148,22 @@ BasicType BasicType::from_type_token(const IDToken &tok) {
 	switch (tok.get_type()) {
 	// type names are always identifiers:
 	case token_type::ID: {
-		auto it0 = primitive_types.find(tok.get_first());
+		std::string name{tok.get_first()};
+
+		auto it0 = primitive_types.find(name);
 		if (it0 != std::end(primitive_types)) {
 			type = it0->second;
 			break;
 		}
 
-		auto it1 = container_types.find(tok.get_first());
+		auto it1 = container_types.find(name);
 		if (it1 != std::end(container_types)) {
 			type = primitive_t::CONTAINER;
 			composite_type = it1->second;
 			break;
 		}
 
-		auto it2 = modifiers.find(tok.get_first());
+		auto it2 = modifiers.find(name);
 		if (it2 != std::end(modifiers)) {
 			type = primitive_t::MODIFIER;
 			composite_type = it2->second;
@@ -2,6 +2,8 @@
 
 #include "c3.h"
 
+#include <deque>
+
 #include "compiler.h"
 #include "object_state.h"
 #include "util.h"
@@ -32,7 +34,8 @@ std::vector<fqon_t> linearize(const fqon_t &name, const objstate_fetch_t &get_ob
 std::vector<fqon_t>
 linearize_recurse(const fqon_t &name,
                   const objstate_fetch_t &get_obj,
-                  std::unordered_set<fqon_t> *seen) {
+                  std::unordered_set<fqon_t> *seen,
+                  const linearization_fetch_t &get_known) {
 	using namespace std::string_literals;
 
 	// test for inheritance loops
@@ -58,19 +61,29 @@ linearize_recurse(const fqon_t &name,
 	// Get parents of object.
 	const auto &parents = obj_state.get_parents();
 
-	// Calculate the parent linearization recursively
-	std::vector<std::vector<fqon_t>> par_linearizations;
+	// Parent linearizations that had to be calculated here.
+	// A deque so the pointers to them stay valid.
+	std::deque<std::vector<fqon_t>> calculated;
+
+	// Linearizations of the parents to merge
+	std::vector<const std::vector<fqon_t> *> par_linearizations;
 	par_linearizations.reserve(parents.size() + 1);
 
 	for (auto &parent : parents) {
+		const std::vector<fqon_t> *known = get_known ? get_known(parent) : nullptr;
+		if (known != nullptr) {
+			par_linearizations.push_back(known);
+			continue;
+		}
+
 		// Recursive call to get the linearization of the parent
 		par_linearizations.push_back(
-			linearize_recurse(parent, get_obj, seen));
+			&calculated.emplace_back(linearize_recurse(parent, get_obj, seen, get_known)));
 	}
 
 	// And at the end, add all parents of this object to the merge-list.
 	par_linearizations.push_back(
-		{std::begin(parents), std::end(parents)});
+		&calculated.emplace_back(std::begin(parents), std::end(parents)));
 
 	// remove current name from the seen set
 	// we only needed it for the recursive call above.
@@ -90,7 +103,7 @@ linearize_recurse(const fqon_t &name,
 
 		// Try to find a head that is not element of any tail
 		for (size_t i = 0; i < par_linearizations.size(); i++) {
-			const auto &par_linearization = par_linearizations[i];
+			const auto &par_linearization = *par_linearizations[i];
 			const size_t headpos = sublists_heads[i];
 
 			// The head position has reached the end (i.e. the list is "empty")
@@ -110,7 +123,7 @@ linearize_recurse(const fqon_t &name,
 					continue;
 				}
 
-				const auto &tail = par_linearizations[j];
+				const auto &tail = *par_linearizations[j];
 				const size_t headpos_try = sublists_heads[j];
 
 				// Start one slot after the head
@@ -146,7 +159,7 @@ linearize_recurse(const fqon_t &name,
 
 			// Advance all the lists where the candidate was the head
 			for (size_t i = 0; i < par_linearizations.size(); i++) {
-				const auto &par_linearization = par_linearizations[i];
+				const auto &par_linearization = *par_linearizations[i];
 				const size_t headpos = sublists_heads[i];
 
 				if (headpos < par_linearization.size()) {
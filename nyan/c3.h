@@ -20,6 +20,13 @@ class ObjectState;
 using objstate_fetch_t = std::function<const ObjectState &(const fqon_t &)>;
 
 
+/**
+ * Function to fetch an already calculated linearization of an object.
+ * Returns nullptr if the linearization is not known yet.
+ */
+using linearization_fetch_t = std::function<const std::vector<fqon_t> *(const fqon_t &)>;
+
+
 /**
  * Implements the C3 multi inheritance linearization algorithm
  * to bring the parents of an object into the "right" order.
@@ -39,13 +46,16 @@ std::vector<fqon_t> linearize(const fqon_t &name, const objstate_fetch_t &get_ob
  * @param name Identifier of the object that is linearized.
  * @param get_obj Function to retrive the ObjectState of the object.
  * @param seen Set of objects that have already been found. Should be empty on initial call.
+ * @param get_known Function to fetch parent linearizations that were calculated before,
+ *     they are then not calculated again. May be empty.
  *
  * @return A C3 linearization of the object's parents.
  */
 std::vector<fqon_t>
 linearize_recurse(const fqon_t &name,
                   const objstate_fetch_t &get_obj,
-                  std::unordered_set<fqon_t> *seen);
+                  std::unordered_set<fqon_t> *seen,
+                  const linearization_fetch_t &get_known = nullptr);
 
 
 /**
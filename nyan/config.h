@@ -35,6 +35,9 @@ using fqnn_t = fqon_t;
 /** member name identifier type */
 using memberid_t = std::string;
 
+/** interned fqon_t or memberid_t, see SymbolTable */
+using symbol_t = uint32_t;
+
 /** member and override nesting depth type */
 using override_depth_t = unsigned;
 
@@ -2,8 +2,13 @@
 
 #pragma once
 
+#include <algorithm>
 #include <functional>
+#include <iterator>
 #include <map>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "compiler.h"
 #include "config.h"
@@ -13,10 +18,43 @@
 
 namespace nyan {
 
-template <typename T>
+/**
+ * Keyframe storage of a Curve.
+ */
+enum class curve_storage {
+	/**
+	 * Contiguous vector sorted by time, searched by bisection.
+	 * Appending a keyframe is cheap, inserting before the end moves
+	 * the later keyframes.
+	 * References to values are invalidated by insertions.
+	 */
+	VECTOR,
+
+	/**
+	 * Red-black tree. References to values stay valid
+	 * until their keyframe is removed.
+	 */
+	MAP,
+};
+
+
+/**
+ * Keyframes over time.
+ * Curves that need stable references to their values
+ * select curve_storage::MAP explicitly.
+ */
+template <typename T, curve_storage storage = curve_storage::VECTOR>
 class Curve {
 public:
-	using container_t = std::map<order_t, T>;
+	using container_t = std::conditional_t<
+		storage == curve_storage::MAP,
+		std::map<order_t, T>,
+		std::vector<std::pair<order_t, T>>>;
+
+	/**
+	 * A single keyframe of the curve: time and value.
+	 */
+	using keyframe_t = typename container_t::value_type;
 
 	using fallback_t = std::function<const T &(const order_t)>;
 
@@ -34,9 +72,6 @@ public:
 	fallback_t fallback;
 #endif
 
-	// TODO: maybe add variants of the functions below
-	//       which also return the time the keyframe belongs to.
-
 	/**
 	 * Get the first value after a given point in time.
 	 *
@@ -45,9 +80,8 @@ public:
 	 * @return The first value that can be found after 'time'.
 	 */
 	const T &at(const order_t time) const {
-		// search for element which is greater than time
-		auto it = this->container.upper_bound(time);
-		if (it == std::begin(this->container)) {
+		const keyframe_t *keyframe = this->keyframe_at(time);
+		if (keyframe == nullptr) {
 #ifdef CURVE_FALLBACK_FUNCTION
 			if (likely(this->fallback)) {
 				return this->fallback(time);
@@ -61,9 +95,7 @@ public:
 #endif
 		}
 
-		// go one back, so it's less or equal the requested time.
-		--it;
-		return it->second;
+		return keyframe->second;
 	}
 
 	/**
@@ -74,12 +106,52 @@ public:
 	 * @return The first value that can be found after 'time' if one exists, else nullptr.
 	 */
 	const T *at_find(const order_t time) const {
-		auto it = this->container.upper_bound(time);
+		const keyframe_t *keyframe = this->keyframe_at(time);
+		if (keyframe == nullptr) {
+			return nullptr;
+		}
+		return &keyframe->second;
+	}
+
+	/**
+	 * Like `at_find`, but also provides the time of the keyframe.
+	 *
+	 * @param time The point in time after which the method searches for a value.
+	 *
+	 * @return The last keyframe at or before 'time' if one exists, else nullptr.
+	 */
+	const keyframe_t *keyframe_at(const order_t time) const {
+		if (this->container.empty()) {
+			return nullptr;
+		}
+
+		// fast path for queries of the latest value, e.g. at LATEST_T
+		const keyframe_t &latest = *std::prev(std::end(this->container));
+		if (time >= latest.first) {
+			return &latest;
+		}
+
+		// search for element which is greater than time
+		auto it = upper_bound(this->container, time);
 		if (it == std::begin(this->container)) {
 			return nullptr;
 		}
+
+		// go one back, so it's less or equal the requested time.
 		--it;
-		return &it->second;
+		return &(*it);
+	}
+
+	/**
+	 * Get the latest keyframe of the curve.
+	 *
+	 * @return The keyframe with the highest time if one exists, else nullptr.
+	 */
+	const keyframe_t *last() const {
+		if (this->container.empty()) {
+			return nullptr;
+		}
+		return &(*std::prev(std::end(this->container)));
 	}
 
 	/**
@@ -90,8 +162,8 @@ public:
 	 * @return Value at the given time if it exists, else nullptr.
 	 */
 	const T *at_exact(const order_t time) const {
-		auto it = this->container.find(time);
-		if (it == std::end(this->container)) {
+		auto it = lower_bound(this->container, time);
+		if (it == std::end(this->container) or it->first != time) {
 			return nullptr;
 		}
 
@@ -107,7 +179,7 @@ public:
 	 */
 	const T &before(const order_t time) const {
 		// search for element which is not less than the given time.
-		auto it = this->container.lower_bound(time);
+		auto it = lower_bound(this->container, time);
 		if (it == std::begin(this->container)) {
 			throw InternalError{"curve has no previous keyframe"};
 		}
@@ -135,23 +207,97 @@ public:
 	 * @return The inserted value.
 	 */
 	T &insert_drop(const order_t time, T &&value) {
-		auto it = this->container.lower_bound(time);
-
 		// remove all elements greater or equal the requested time
-		this->container.erase(it, std::end(this->container));
+		this->drop(time);
+
+		// the new keyframe is the latest one now.
+		if constexpr (storage == curve_storage::MAP) {
+			return this->container.emplace_hint(
+				std::end(this->container),
+				time,
+				std::move(value))->second;
+		}
+		else {
+			return this->container.emplace_back(time, std::move(value)).second;
+		}
+	}
+
+	/**
+	 * Insert a new keyframe with a value into the curve.
+	 * Unlike `insert_drop`, later keyframes are kept.
+	 * An existing keyframe at the same time is replaced.
+	 *
+	 * @param time The point in time at which the value is inserted.
+	 * @param value Value that is inserted.
+	 *
+	 * @return The inserted value.
+	 */
+	T &insert(const order_t time, T &&value) {
+		auto it = lower_bound(this->container, time);
+		if (it != std::end(this->container) and it->first == time) {
+			it->second = std::move(value);
+			return it->second;
+		}
 
-		// insert the new keyframe
-		auto ret = this->container.insert({time, std::move(value)});
-		if (unlikely(ret.second == false)) {
-			throw InternalError{"did not insert value, it existed before"};
+		if constexpr (storage == curve_storage::MAP) {
+			return this->container.emplace_hint(it, time, std::move(value))->second;
+		}
+		else {
+			return this->container.emplace(it, time, std::move(value))->second;
 		}
+	}
 
-		return ret.first->second;
+	/**
+	 * Remove all keyframes at or after a given time.
+	 *
+	 * @param time The point in time from which on keyframes are removed.
+	 */
+	void drop(const order_t time) {
+		auto it = lower_bound(this->container, time);
+		this->container.erase(it, std::end(this->container));
 	}
 
 protected:
 	/**
-	 * Keyframes of the curve, stored as a map of values by time.
+	 * Find the first keyframe that is later than the given time.
+	 */
+	template <typename C>
+	static auto upper_bound(C &container, const order_t time) {
+		if constexpr (storage == curve_storage::MAP) {
+			return container.upper_bound(time);
+		}
+		else {
+			return std::upper_bound(
+				std::begin(container),
+				std::end(container),
+				time,
+				[](const order_t t, const keyframe_t &keyframe) {
+					return t < keyframe.first;
+				});
+		}
+	}
+
+	/**
+	 * Find the first keyframe that is not earlier than the given time.
+	 */
+	template <typename C>
+	static auto lower_bound(C &container, const order_t time) {
+		if constexpr (storage == curve_storage::MAP) {
+			return container.lower_bound(time);
+		}
+		else {
+			return std::lower_bound(
+				std::begin(container),
+				std::end(container),
+				time,
+				[](const keyframe_t &keyframe, const order_t t) {
+					return keyframe.first < t;
+				});
+		}
+	}
+
+	/**
+	 * Keyframes of the curve, ordered by time.
 	 */
 	container_t container;
 };
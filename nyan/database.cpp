@@ -2,20 +2,29 @@
 
 #include "database.h"
 
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <limits>
 #include <memory>
 #include <queue>
 #include <unordered_map>
+#include <unordered_set>
 
+#include "api_error.h"
 #include "c3.h"
 #include "compiler.h"
 #include "error.h"
 #include "file.h"
+#include "lineage.h"
 #include "namespace.h"
 #include "object_state.h"
 #include "parser.h"
 #include "patch_info.h"
+#include "snapshot.h"
 #include "state.h"
 #include "util.h"
+#include "util/thread_pool.h"
 #include "view.h"
 
 
@@ -47,10 +56,10 @@ using ast_objwalk_cb_t = std::function<void(const NamespaceFinder &,
 static void ast_obj_walk_recurser(const ast_objwalk_cb_t &callback,
                                   const NamespaceFinder &scope,
                                   const Namespace &ns,
-                                  const std::vector<ASTObject> &objs) {
+                                  const std::pmr::vector<ASTObject> &objs) {
 	// go over all objects
 	for (auto &astobj : objs) {
-		Namespace objname{ns, astobj.get_name().get()};
+		Namespace objname{ns, std::string{astobj.get_name().get()}};
 
 		// process nested objects first
 		ast_obj_walk_recurser(callback, scope, objname, astobj.get_objects());
@@ -75,73 +84,92 @@ static void ast_obj_walk(const namespace_lookup_t &imports,
 }
 
 
-void Database::load(const std::string &filename,
-                    const filefetcher_t &filefetcher) {
-	Parser parser;
+/**
+ * An object found by ast_obj_walk, stored to process it again.
+ */
+struct ast_obj_entry {
+	const NamespaceFinder *scope;
+	Namespace ns;
+	Namespace objname;
+	const ASTObject *astobj;
+};
+
 
+void Database::load(const std::string &filename,
+                    const filefetcher_t &filefetcher,
+                    size_t threads) {
 	// tracking of imported namespaces (with aliases)
 	namespace_lookup_t imports;
 
-	// namespaces to which were requested to be imported
+	// namespaces which were requested to be imported.
+	std::unordered_set<Namespace> requested;
+
+	// files that are fetched and parsed, in the order they were requested.
+	// they are merged in this order, no matter which parse finishes first,
+	// so the result doesn't depend on the thread timing.
+	std::queue<std::pair<Namespace, std::future<AST>>> pending;
+
+	// with a single thread, everything is processed in this thread.
+	// destroyed first, so no task outlives the data it references.
+	util::ThreadPool pool{threads > 1 ? threads : 0};
+
+	// fetch and parse a file in the thread pool.
 	// the location is the first request origin.
-	std::unordered_map<Namespace, Location> to_import;
+	auto request_import = [&](Namespace &&ns, const Location &req_location) {
+		std::future<AST> ast = pool.submit(
+			[&filefetcher, filepath = ns.to_filepath(), req_location]() {
+				std::shared_ptr<File> file;
+				try {
+					// get the data
+					file = filefetcher(filepath);
+				}
+				catch (FileReadError &err) {
+					// the import request failed,
+					// so the nyan file structure or content is wrong.
+					throw LangError{req_location, err.str()};
+				}
+
+				// read the ast!
+				Parser parser;
+				return parser.parse(file);
+			});
+
+		requested.insert(ns);
+		pending.emplace(std::move(ns), std::move(ast));
+	};
 
 	auto file_ns = Namespace::from_filename(filename);
 	if (not this->meta_info.has_namespace(file_ns.to_fqon())) {
 		// push the first namespace to import
-		to_import.insert(
-			{file_ns,
-		     Location{" -> requested by native call to Database::load()"}});
+		request_import(
+			std::move(file_ns),
+			Location{" -> requested by native call to Database::load()"});
 	}
 
 	// descend to all imports and load the files
-	while (to_import.size() > 0) {
-		auto cur_ns_it = to_import.begin();
-		const Namespace &namespace_to_import = cur_ns_it->first;
-		const Location &req_location = cur_ns_it->second;
-
-		auto it = imports.find(namespace_to_import);
-		if (it != std::end(imports)) {
-			// this namespace is already imported!
-			to_import.erase(cur_ns_it);
-			continue;
-		}
+	while (not pending.empty()) {
+		Namespace namespace_to_import = std::move(pending.front().first);
 
-		std::shared_ptr<File> current_file;
-		try {
-			// get the data and parse the file
-			current_file = filefetcher(
-				namespace_to_import.to_filepath());
-		}
-		catch (FileReadError &err) {
-			// the import request failed,
-			// so the nyan file structure or content is wrong.
-			throw LangError{req_location, err.str()};
-		}
+		// wait until the file is parsed.
+		// rethrows the errors of fetching and parsing.
+		AST ast = pending.front().second.get();
+		pending.pop();
 
 		// create import tracking entry for this file
-		// and parse the file contents!
-		NamespaceFinder &new_ns = imports.insert({namespace_to_import, // name of the import
-		                                          NamespaceFinder{
-													  parser.parse(current_file) // read the ast!
-												  }})
+		NamespaceFinder &new_ns = imports.insert({std::move(namespace_to_import), // name of the import
+		                                          NamespaceFinder{std::move(ast)}})
 		                              .first->second;
 
-		// Processing import is done and we can remove it from the list
-		// We must already erase here because the iterator cur_ns_it might get
-		// invalidated by an insert into to_import further below
-		to_import.erase(cur_ns_it);
-
 		// enqueue all new imports of this file
 		// and record import aliases
 		for (auto &import : new_ns.get_ast().get_imports()) {
-			std::vector<Token> components = import.get().get_components();
+			const auto &components = import.get().get_components();
 			std::vector<std::string> dir_components;
 			dir_components.reserve(components.size() - 1);
 			for (size_t i = 0; i < components.size() - 1; ++i) {
-				dir_components.push_back(components[i].get());
+				dir_components.emplace_back(components[i].get());
 			}
-			std::string filename = components.back().get();
+			std::string filename{components.back().get()};
 			Namespace request{std::move(dir_components), std::move(filename)};
 
 			// either register the alias
@@ -154,19 +182,15 @@ void Database::load(const std::string &filename,
 			}
 
 			// check if this import was already requested or is known.
-			auto was_imported = imports.find(request);
-			auto import_requested = to_import.find(request);
-
-			if (was_imported == std::end(imports) and import_requested == std::end(to_import)) {
+			if (not requested.contains(request)) {
 				if (not this->meta_info.has_namespace(request.to_fqon())) {
-					// add the request to the pending imports
-					to_import.insert({std::move(request), import.get()});
+					// start loading the file while the others are processed
+					request_import(std::move(request), Location{import.get()});
 				}
 			}
 		}
 	}
 
-
 	using namespace std::placeholders;
 
 	// now that we have all imports, process the nyan-objects in those files.
@@ -200,27 +224,65 @@ void Database::load(const std::string &filename,
 	                       _3,
 	                       _4));
 
+	// from here on, the objects are processed independently of each other
+	// and each pass is a sync point: the pool may process them in parallel.
+
 	// linearize the parents of all new objects
-	this->linearize_new(new_objects);
+	this->linearize_new(new_objects, pool);
 
 	// resolve the types of members to their definition
-	this->resolve_types(new_objects);
+	this->resolve_types(new_objects, pool);
+
+	// the objects in the order of the serial walk
+	std::vector<ast_obj_entry> ast_objs;
+	ast_objs.reserve(new_objects.size());
+	ast_obj_walk(imports,
+	             [&ast_objs](const NamespaceFinder &scope,
+	                         const Namespace &ns,
+	                         const Namespace &objname,
+	                         const ASTObject &astobj) {
+		             ast_objs.push_back({&scope, ns, objname, &astobj});
+	             });
 
 	// these objects were uses as values at some file location.
-	std::vector<std::pair<fqon_t, Location>> objs_in_values;
+	// collected per object and merged in walk order.
+	std::vector<std::vector<std::pair<fqon_t, Location>>> obj_values(ast_objs.size());
 
 	// third run: state value creation, create object members/values
-	ast_obj_walk(imports,
-	             std::bind(&Database::create_obj_state,
-	                       this,
-	                       &objs_in_values,
-	                       _1,
-	                       _2,
-	                       _3,
-	                       _4));
+	pool.parallel_for(ast_objs.size(), [this, &ast_objs, &obj_values](size_t idx) {
+		const ast_obj_entry &entry = ast_objs[idx];
+		this->create_obj_state(&obj_values[idx],
+		                       *entry.scope,
+		                       entry.ns,
+		                       entry.objname,
+		                       *entry.astobj);
+	});
+
+	std::vector<std::pair<fqon_t, Location>> objs_in_values;
+	for (auto &values : obj_values) {
+		objs_in_values.insert(std::end(objs_in_values),
+		                      std::make_move_iterator(std::begin(values)),
+		                      std::make_move_iterator(std::end(values)));
+	}
 
 	// verify hierarchy consistency
-	this->check_hierarchy(new_objects, objs_in_values);
+	this->check_hierarchy(new_objects, objs_in_values, pool);
+
+	// precompute the inheritance facts now that all members exist.
+	pool.parallel_for(new_objects.size(), [this, &new_objects](size_t idx) {
+		ObjectInfo *obj_info = this->meta_info.get_object(new_objects[idx]);
+		if (unlikely(obj_info == nullptr)) {
+			throw InternalError{"object information not retrieved"};
+		}
+
+		obj_info->set_lineage(
+			Lineage{
+				obj_info->get_linearization(),
+				this->meta_info,
+				[this](symbol_t parent) -> const ObjectState & {
+					return **this->state->get(parent);
+				}});
+	});
 
 	// store the children mapping.
 	for (auto &it : obj_children) {
@@ -235,7 +297,7 @@ void Database::load(const std::string &filename,
 		info->add_children(std::move(children));
 	}
 
-	for (auto loaded : imports) {
+	for (auto &loaded : imports) {
 		this->meta_info.add_namespace(loaded.first);
 	}
 
@@ -248,7 +310,7 @@ void Database::create_obj_info(size_t *counter,
                                const Namespace &,
                                const Namespace &objname,
                                const ASTObject &astobj) {
-	const std::string &name = astobj.name.get();
+	std::string name{astobj.name.get()};
 
 	// object name must not be an alias
 	if (current_file.check_conflict(name)) {
@@ -315,7 +377,7 @@ void Database::create_obj_content(std::vector<fqon_t> *new_objs,
 
 	// fill initial state:
 	this->state->add_object(
-		obj_fqon,
+		this->get_symbol(obj_fqon),
 		std::make_shared<ObjectState>(
 			std::move(object_parents)));
 
@@ -330,6 +392,8 @@ void Database::create_obj_content(std::vector<fqon_t> *new_objs,
 			astmember.name.str(),
 			MemberInfo{astmember.name});
 
+		this->meta_info.get_member_symbols().intern(astmember.name.str());
+
 		// it doesn't exist if the user didn't specify it.
 		// it's not set
 		if (not astmember.type.has_value()) {
@@ -349,24 +413,106 @@ void Database::create_obj_content(std::vector<fqon_t> *new_objs,
 }
 
 
-void Database::linearize_new(const std::vector<fqon_t> &new_objects) {
-	// linearize the parents of all newly created objects
+/**
+ * Find the wave in which a new object can be linearized:
+ * after all waves that linearize its new parents.
+ * Objects without a linearization yet are new.
+ *
+ * @param obj Identifier of the new object.
+ * @param meta_info Information of the objects, for their linearizations.
+ * @param get_obj Function to fetch the object states.
+ * @param waves Waves of the new objects that were visited already.
+ *
+ * @return Wave index of the object.
+ */
+static size_t linearization_wave(const fqon_t &obj,
+                                 const MetaInfo &meta_info,
+                                 const objstate_fetch_t &get_obj,
+                                 std::unordered_map<fqon_t, size_t> *waves) {
+	// marks objects whose parents are being visited
+	constexpr size_t visiting = std::numeric_limits<size_t>::max();
+
+	auto known = waves->find(obj);
+	if (known != std::end(*waves)) {
+		// an inheritance loop if the object is visited already,
+		// the linearization reports it.
+		return known->second == visiting ? 0 : known->second;
+	}
 
-	for (auto &obj : new_objects) {
-		std::unordered_set<fqon_t> seen;
+	waves->emplace(obj, visiting);
 
-		ObjectInfo *obj_info = this->meta_info.get_object(obj);
-		if (unlikely(obj_info == nullptr)) {
-			throw InternalError{"object information not retrieved"};
+	size_t wave = 0;
+	for (auto &parent : get_obj(obj).get_parents()) {
+		const ObjectInfo *parent_info = meta_info.get_object(parent);
+		if (parent_info != nullptr and parent_info->get_linearization().empty()) {
+			wave = std::max(wave, linearization_wave(parent, meta_info, get_obj, waves) + 1);
 		}
+	}
 
-		obj_info->set_linearization(
-			linearize_recurse(
-				obj,
-				[this](const fqon_t &name) -> const ObjectState & {
-					return **this->state->get(name);
-				},
-				&seen));
+	(*waves)[obj] = wave;
+	return wave;
+}
+
+
+void Database::linearize_new(const std::vector<fqon_t> &new_objects,
+                             util::ThreadPool &pool) {
+	auto get_obj = [this](const fqon_t &name) -> const ObjectState & {
+		return **this->state->get(this->get_symbol(name));
+	};
+
+	// linearize the new objects in waves, parents before their children.
+	// then the linearization of a parent is only calculated once
+	// and merged from there for all its children.
+	std::unordered_map<fqon_t, size_t> obj_waves;
+	std::vector<std::vector<size_t>> waves;
+	for (size_t idx = 0; idx < new_objects.size(); idx++) {
+		size_t wave = linearization_wave(new_objects[idx], this->meta_info, get_obj, &obj_waves);
+		if (wave >= waves.size()) {
+			waves.resize(wave + 1);
+		}
+		waves[wave].push_back(idx);
+	}
+
+	// linearizations of earlier waves and loads
+	auto get_known = [this](const fqon_t &name) -> const std::vector<fqon_t> * {
+		const ObjectInfo *info = this->meta_info.get_object(name);
+		if (info == nullptr or info->get_linearization().empty()) {
+			return nullptr;
+		}
+		return &info->get_linearization();
+	};
+
+	// errors of each new object, reported in walk order below.
+	// children of a failed object find no linearization of it
+	// and calculate it themselves, so they fail like a serial walk.
+	std::vector<std::exception_ptr> errors(new_objects.size());
+
+	// objects within a wave don't depend on each other.
+	for (auto &wave : waves) {
+		pool.parallel_for(wave.size(), [this, &new_objects, &wave, &errors, &get_obj, &get_known](size_t idx) {
+			const fqon_t &obj = new_objects[wave[idx]];
+
+			try {
+				std::unordered_set<fqon_t> seen;
+
+				ObjectInfo *obj_info = this->meta_info.get_object(obj);
+				if (unlikely(obj_info == nullptr)) {
+					throw InternalError{"object information not retrieved"};
+				}
+
+				obj_info->set_linearization(
+					linearize_recurse(obj, get_obj, &seen, get_known));
+			}
+			catch (...) {
+				errors[wave[idx]] = std::current_exception();
+			}
+		});
+	}
+
+	for (auto &error : errors) {
+		if (error) {
+			std::rethrow_exception(error);
+		}
 	}
 }
 
@@ -426,11 +572,16 @@ void Database::find_member(bool skip_first,
 			continue;
 		}
 
-		const ObjectState *par_state = this->state->get(obj)->get();
+		const ObjectState *par_state = this->state->get(this->get_symbol(obj))->get();
 		if (unlikely(par_state == nullptr)) {
 			throw InternalError{"object state not retrieved"};
 		}
-		const Member *member = par_state->get(member_name);
+
+		const Member *member = nullptr;
+		const symbol_t *member_symbol = this->meta_info.get_member_symbols().find(member_name);
+		if (member_symbol != nullptr) {
+			member = par_state->get(*member_symbol);
+		}
 
 		finished = member_found(obj, *obj_member_info, member);
 
@@ -455,16 +606,21 @@ void Database::find_member(bool skip_first,
 }
 
 
-void Database::resolve_types(const std::vector<fqon_t> &new_objects) {
+void Database::resolve_types(const std::vector<fqon_t> &new_objects,
+                             util::ThreadPool &pool) {
 	using namespace std::string_literals;
 
 	// TODO: if inheritance parents are added,
 	//       should a patch be able to modify the newly accessible members?
 
+	// patches by inheritance, linked after all objects were searched
+	// so no object info is read while it is written.
+	std::vector<std::vector<std::shared_ptr<PatchInfo>>> inherited_patches(new_objects.size());
+
 	// link patch information to the origin patch
 	// and check if there's not multiple patche targets per object hierarchy
-	for (auto &obj : new_objects) {
-		ObjectInfo *obj_info = this->meta_info.get_object(obj);
+	pool.parallel_for(new_objects.size(), [this, &new_objects, &inherited_patches](size_t idx) {
+		ObjectInfo *obj_info = this->meta_info.get_object(new_objects[idx]);
 
 		const auto &linearization = obj_info->get_linearization();
 		if (unlikely(linearization.size() < 1)) {
@@ -488,18 +644,31 @@ void Database::resolve_types(const std::vector<fqon_t> &new_objects) {
 				}
 				else {
 					// this is patch because of inheritance.
-					// false => it wasn't initially a patch.
-					obj_info->add_patch(parent_info->get_patch(), false);
+					inherited_patches[idx].push_back(parent_info->get_patch());
 				}
 			}
 		}
+	});
+
+	for (size_t idx = 0; idx < new_objects.size(); idx++) {
+		ObjectInfo *obj_info = this->meta_info.get_object(new_objects[idx]);
+		for (auto &patch : inherited_patches[idx]) {
+			// false => it wasn't initially a patch.
+			obj_info->add_patch(patch, false);
+		}
 	}
 
+	// inherited member types, stored after all objects were searched
+	// so no object reads a member info that is written at the same time.
+	using inherited_types_t = std::vector<std::pair<MemberInfo *, std::shared_ptr<Type>>>;
+	std::vector<inherited_types_t> inherited_types(new_objects.size());
+
 	// resolve member types:
 	// link member types to matching parent if not known yet.
 	// this required that patch targets are linked.
-	for (auto &obj : new_objects) {
-		ObjectInfo *obj_info = this->meta_info.get_object(obj);
+	pool.parallel_for(new_objects.size(), [this, &new_objects, &inherited_types](size_t idx) {
+		ObjectInfo *obj_info = this->meta_info.get_object(new_objects[idx]);
+		inherited_types_t &obj_types = inherited_types[idx];
 
 		const auto &linearization = obj_info->get_linearization();
 
@@ -519,9 +688,9 @@ void Database::resolve_types(const std::vector<fqon_t> &new_objects) {
 				member_id,
 				linearization,
 				*obj_info,
-				[&member_info, &type_found, &member_id](const fqon_t &parent,
-			                                            const MemberInfo &source_member_info,
-			                                            const Member *) {
+				[&member_info, &type_found, &member_id, &obj_types](const fqon_t &parent,
+			                                                        const MemberInfo &source_member_info,
+			                                                        const Member *) {
 					if (source_member_info.is_initial_def()) {
 						const std::shared_ptr<Type> &new_type = source_member_info.get_type();
 
@@ -543,7 +712,7 @@ void Database::resolve_types(const std::vector<fqon_t> &new_objects) {
 						}
 
 						type_found = true;
-						member_info.set_type(new_type, false);
+						obj_types.emplace_back(&member_info, new_type);
 					}
 					// else that member knows the type,
 				    // but we're looking for the initial definition.
@@ -559,6 +728,12 @@ void Database::resolve_types(const std::vector<fqon_t> &new_objects) {
 						+ "' from parents or patch target"};
 			}
 		}
+	});
+
+	for (auto &obj_types : inherited_types) {
+		for (auto &it : obj_types) {
+			it.first->set_type(std::move(it.second), false);
+		}
 	}
 }
 
@@ -580,9 +755,9 @@ void Database::create_obj_state(std::vector<std::pair<fqon_t, Location>> *objs_i
 		throw InternalError{"object info could not be retrieved"};
 	}
 
-	ObjectState &objstate = **this->state->get(objname.to_fqon());
+	ObjectState &objstate = **this->state->get(this->get_symbol(objname.to_fqon()));
 
-	std::unordered_map<memberid_t, Member> members;
+	std::unordered_map<symbol_t, Member> members;
 
 	// create member values
 	for (auto &astmember : astobj.members) {
@@ -635,9 +810,16 @@ void Database::create_obj_state(std::vector<std::pair<fqon_t, Location>> *objs_i
 			return obj_info->get_linearization();
 		};
 
+		// the symbol was interned when the member info was created.
+		// objects are processed in parallel, so the table must not change.
+		const symbol_t *member_symbol = this->meta_info.get_member_symbols().find(memberid);
+		if (unlikely(member_symbol == nullptr)) {
+			throw InternalError{"member symbol was not interned"};
+		}
+
 		// create the member with operation, type and value
 		Member &new_member = members.emplace(
-										memberid,
+										*member_symbol,
 										Member{
 											0, // TODO: get override depth from AST (the @-count)
 											operation,
@@ -680,12 +862,14 @@ void Database::create_obj_state(std::vector<std::pair<fqon_t, Location>> *objs_i
 
 
 void Database::check_hierarchy(const std::vector<fqon_t> &new_objs,
-                               const std::vector<std::pair<fqon_t, Location>> &objs_in_values) {
+                               const std::vector<std::pair<fqon_t, Location>> &objs_in_values,
+                               util::ThreadPool &pool) {
 	using namespace std::string_literals;
 
-	for (auto &obj : new_objs) {
+	pool.parallel_for(new_objs.size(), [this, &new_objs](size_t idx) {
+		const fqon_t &obj = new_objs[idx];
 		ObjectInfo *obj_info = this->meta_info.get_object(obj);
-		ObjectState *obj_state = this->state->get(obj)->get();
+		ObjectState *obj_state = this->state->get(this->get_symbol(obj))->get();
 		if (unlikely(obj_info == nullptr)) {
 			throw InternalError{"object info could not be retrieved"};
 		}
@@ -706,12 +890,13 @@ void Database::check_hierarchy(const std::vector<fqon_t> &new_objs,
 
 		// check that relative operators can't be performed when the parent has no value.
 		for (auto &it : obj_state->get_members()) {
+			const memberid_t &member_id = this->meta_info.get_member_symbols().get_name(it.first);
 			bool assign_ok = false;
 			bool other_op = false;
 
 			this->find_member(
 				false,
-				it.first,
+				member_id,
 				linearization,
 				*obj_info,
 				[&assign_ok, &other_op](const fqon_t &, const MemberInfo &, const Member *member) {
@@ -736,7 +921,7 @@ void Database::check_hierarchy(const std::vector<fqon_t> &new_objs,
 				});
 
 			if (unlikely(other_op and not assign_ok)) {
-				const MemberInfo *member_info = obj_info->get_member(it.first);
+				const MemberInfo *member_info = obj_info->get_member(member_id);
 				throw LangError{
 					member_info->get_location(),
 					"this member was never assigned a value."};
@@ -745,7 +930,7 @@ void Database::check_hierarchy(const std::vector<fqon_t> &new_objs,
 
 		// TODO: check the @-propagation is type-compatible for each operator
 		//       -> can we even know? yes, as the patch target depth must be >= @-count.
-	}
+	});
 
 
 	std::unordered_set<fqon_t> obj_values_ok;
@@ -774,7 +959,7 @@ void Database::check_hierarchy(const std::vector<fqon_t> &new_objs,
 			if (unlikely(obj_info == nullptr)) {
 				throw InternalError{"object used as value has no metainfo"};
 			}
-			const ObjectState *obj_state = this->state->get(*obj)->get();
+			const ObjectState *obj_state = this->state->get(this->get_symbol(*obj))->get();
 			if (unlikely(obj_state == nullptr)) {
 				throw InternalError{"object in hierarchy has no state"};
 			}
@@ -786,15 +971,16 @@ void Database::check_hierarchy(const std::vector<fqon_t> &new_objs,
 
 			for (auto &it : obj_info->get_members()) {
 				const memberid_t &member_id = it.first;
+				const symbol_t *member_symbol = this->meta_info.get_member_symbols().find(member_id);
 
-				if (state_members.find(member_id) == std::end(state_members)) {
+				if (member_symbol == nullptr or not state_members.contains(*member_symbol)) {
 					// member is not in the state.
 					pending_members.insert(member_id);
 				}
 			}
 
 			for (auto &it : state_members) {
-				const memberid_t &member_id = it.first;
+				const memberid_t &member_id = this->meta_info.get_member_symbols().get_name(it.first);
 
 				// if the member is inherited, its ID can be prefixed with the ID
 				// of the object it's inherited from, e.g. ParentObj.some_member
@@ -841,9 +1027,97 @@ void Database::check_hierarchy(const std::vector<fqon_t> &new_objs,
 }
 
 
+void Database::save_snapshot(std::ostream &out) const {
+	Snapshot::write(*this, out);
+}
+
+
+std::shared_ptr<Database> Database::load_snapshot(std::istream &in) {
+	return Snapshot::read(in);
+}
+
+
+void Database::release_file_contents() {
+	// the locations of objects and members share one File per source file.
+	std::unordered_set<File *> released;
+
+	auto release = [&released](const Location &location) {
+		File *file = location.get_file().get();
+		if (file != nullptr and released.insert(file).second) {
+			file->release_content();
+		}
+	};
+
+	for (auto &info : this->meta_info.get_objects()) {
+		release(info.get_location());
+
+		for (auto &member : info.get_members()) {
+			release(member.second.get_location());
+		}
+	}
+}
+
+
 std::shared_ptr<View> Database::new_view() {
 	return std::make_shared<View>(shared_from_this());
 }
 
 
+MemberHandle Database::member_handle(const fqon_t &obj, const memberid_t &member) const {
+	const ObjectInfo *obj_info = this->meta_info.get_object(obj);
+	if (unlikely(obj_info == nullptr)) {
+		throw ObjectNotFoundError{obj};
+	}
+
+	const symbol_t *member_symbol = this->meta_info.get_member_symbols().find(member);
+
+	// find the object that defines the member type.
+	// patches may also use the members of their target.
+	const ObjectInfo *search = obj_info;
+	while (member_symbol != nullptr and search != nullptr) {
+		for (auto &parent : search->get_linearization()) {
+			const ObjectInfo *parent_info = this->meta_info.get_object(parent);
+			if (unlikely(parent_info == nullptr)) {
+				throw InternalError{"object info could not be retrieved"};
+			}
+
+			const MemberInfo *member_info = parent_info->get_member(member);
+			if (member_info != nullptr and member_info->is_initial_def()) {
+				return MemberHandle{
+					*member_symbol,
+					member,
+					parent,
+					member_info->get_type()};
+			}
+		}
+
+		if (not search->is_patch()) {
+			break;
+		}
+		search = this->meta_info.get_object(search->get_patch()->get_target());
+	}
+
+	throw MemberNotFoundError{obj, member};
+}
+
+
+symbol_t Database::get_symbol(const fqon_t &obj) const {
+	const symbol_t *symbol = this->meta_info.get_object_symbol(obj);
+	if (unlikely(symbol == nullptr)) {
+		throw InternalError{"object symbol could not be retrieved"};
+	}
+	return *symbol;
+}
+
+
+const std::shared_ptr<util::ThreadPool> &Database::get_transaction_pool(size_t threads) {
+	size_t workers = threads > 1 ? threads : 0;
+
+	auto &pool = this->transaction_pools[workers];
+	if (pool == nullptr) {
+		pool = std::make_shared<util::ThreadPool>(workers);
+	}
+	return pool;
+}
+
 } // namespace nyan
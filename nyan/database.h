@@ -1,12 +1,16 @@
 // Copyright 2016-2023 the nyan authors, LGPLv3+. See copying.md for legal info.
 #pragma once
 
+#include <iosfwd>
 #include <memory>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "config.h"
+#include "member_handle.h"
 #include "meta_info.h"
 #include "namespace_finder.h"
 
@@ -21,6 +25,10 @@ class ObjectState;
 class State;
 class View;
 
+namespace util {
+class ThreadPool;
+} // namespace util
+
 
 /**
  * Be in a namespace, look up an alias, and get the original namespace.
@@ -35,6 +43,10 @@ using namespace_lookup_t = std::unordered_map<Namespace, NamespaceFinder>;
  * it is required for db views so they can store pointers.
  */
 class Database : public std::enable_shared_from_this<Database> {
+	friend class Snapshot;
+	friend class Transaction;
+	friend class View;
+
 public:
 	/**
 	 * Create a new nyan database.
@@ -61,9 +73,40 @@ public:
 	 *
 	 * @param filename Filename of the to-be-loaded file.
 	 * @param filefetcher Function to extract the data from the file.
+	 * @param threads Number of threads that fetch and parse the files.
+	 *     With more than one, \p filefetcher is called concurrently
+	 *     and must be thread-safe.
 	 */
 	void load(const std::string &filename,
-	          const filefetcher_t &filefetcher);
+	          const filefetcher_t &filefetcher,
+	          size_t threads = 1);
+
+	/**
+	 * Write the loaded content to a binary snapshot, see Snapshot.
+	 *
+	 * @param out Binary output stream the snapshot is written to.
+	 */
+	void save_snapshot(std::ostream &out) const;
+
+	/**
+	 * Create a database from a snapshot written by save_snapshot().
+	 * This doesn't parse or check any nyan file.
+	 *
+	 * @param in Binary input stream the snapshot is read from.
+	 *
+	 * @return The restored database.
+	 */
+	static std::shared_ptr<Database> load_snapshot(std::istream &in);
+
+	/**
+	 * Free the content of all files the loaded objects were defined in.
+	 * Their locations stay valid, error messages read the affected
+	 * lines from disk again, see File::release_content().
+	 *
+	 * Call this after load() if the file contents are not needed anymore,
+	 * loading more files afterwards is still possible.
+	 */
+	void release_file_contents();
 
 	/**
 	 * Return a new view to the database, it allows changes.
@@ -72,6 +115,19 @@ public:
 	 */
 	std::shared_ptr<View> new_view();
 
+	/**
+	 * Resolve a member once so that repeated value queries can skip
+	 * the member name lookup, see Object::get_value(const MemberHandle &).
+	 * The member is searched in the object and its parents as they were
+	 * at load time, and in the patch target if the object is a patch.
+	 *
+	 * @param obj Identifier of an object that has the member.
+	 * @param member Identifier of the member.
+	 *
+	 * @return Handle for the member.
+	 */
+	MemberHandle member_handle(const fqon_t &obj, const memberid_t &member) const;
+
 	/**
 	 * Return the initial database state.
 	 *
@@ -147,8 +203,10 @@ protected:
 	 * Linearizes the parents of all given objects.
 	 *
 	 * @param new_objs Identifiers of the objects that should be linearized.
+	 * @param pool Thread pool that processes the objects.
 	 */
-	void linearize_new(const std::vector<fqon_t> &new_objs);
+	void linearize_new(const std::vector<fqon_t> &new_objs,
+	                   util::ThreadPool &pool);
 
 	/**
 	 * Find a member in a given list of objects and perform an operation on it.
@@ -172,8 +230,10 @@ protected:
 	 * members' metadata.
 	 *
 	 * @param new_objs Identifiers of the objects which should be resolved.
+	 * @param pool Thread pool that processes the objects.
 	 */
-	void resolve_types(const std::vector<fqon_t> &new_objs);
+	void resolve_types(const std::vector<fqon_t> &new_objs,
+	                   util::ThreadPool &pool);
 
 	/**
 	 * Sanity check after creating the database, e.g.
@@ -184,9 +244,32 @@ protected:
 	 *
 	 * @param new_objs Identifiers of the objects which should be checked.
 	 * @param objs_in_values Object identifiers in the object's member values that must be non-abstract.
+	 * @param pool Thread pool that processes the objects.
 	 */
 	void check_hierarchy(const std::vector<fqon_t> &new_objs,
-	                     const std::vector<std::pair<fqon_t, Location>> &objs_in_values);
+	                     const std::vector<std::pair<fqon_t, Location>> &objs_in_values,
+	                     util::ThreadPool &pool);
+
+	/**
+	 * Get the symbol of an object that was added to the metadata information.
+	 *
+	 * @param obj Identifier of the object.
+	 *
+	 * @return Symbol of the object.
+	 */
+	symbol_t get_symbol(const fqon_t &obj) const;
+
+	/**
+	 * Get the thread pool for transactions with a number of threads.
+	 * The pool is created on first use and lives as long as the database,
+	 * so transactions don't start and join their own workers.
+	 * Must be called with transaction_mutex held exclusively.
+	 *
+	 * @param threads Number of threads requested for the transaction.
+	 *
+	 * @return Pool with that many workers, or without workers for a single thread.
+	 */
+	const std::shared_ptr<util::ThreadPool> &get_transaction_pool(size_t threads);
 
 	/**
 	 * Database start state.
@@ -198,6 +281,19 @@ protected:
 	 * Tracks type information and locations of the database content etc.
 	 */
 	MetaInfo meta_info;
+
+	/**
+	 * Orders transactions with each other and with view snapshots.
+	 * Held exclusively while a transaction is created or committed,
+	 * and shared while one is filled or a view snapshot is taken.
+	 */
+	std::shared_mutex transaction_mutex;
+
+	/**
+	 * Thread pools of the transactions, by their number of workers.
+	 * Guarded by transaction_mutex.
+	 */
+	std::unordered_map<size_t, std::shared_ptr<util::ThreadPool>> transaction_pools;
 };
 
 } // namespace nyan
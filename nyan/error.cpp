@@ -252,4 +252,12 @@ InternalError::InternalError(const std::string &msg) :
 FileReadError::FileReadError(const std::string &msg) :
 	Error{msg} {}
 
+
+SnapshotError::SnapshotError(const std::string &msg) :
+	Error{msg} {}
+
+
+ConflictError::ConflictError(const std::string &msg) :
+	Error{msg} {}
+
 } // namespace nyan
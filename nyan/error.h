@@ -224,4 +224,24 @@ public:
 	FileReadError(const std::string &msg);
 };
 
+
+/**
+ * Error thrown when a database snapshot can't be written or restored,
+ * i.e. the output fails, or it is truncated, corrupted or has another format version.
+ */
+class SnapshotError : public Error {
+public:
+	SnapshotError(const std::string &msg);
+};
+
+
+/**
+ * Error stored in a transaction that could not be committed
+ * because another transaction changed objects it used in the meantime.
+ */
+class ConflictError : public Error {
+public:
+	ConflictError(const std::string &msg);
+};
+
 } // namespace nyan
@@ -2,6 +2,7 @@
 
 #include "file.h"
 
+#include "compiler.h"
 #include "error.h"
 #include "util.h"
 
@@ -11,7 +12,8 @@ namespace nyan {
 
 File::File(const std::string &virtual_name, std::string &&data) :
 	name{virtual_name},
-	data{std::move(data)} {
+	data{std::move(data)},
+	content{this->data} {
 	this->extract_lines();
 }
 
@@ -19,18 +21,51 @@ File::File(const std::string &virtual_name, std::string &&data) :
 File::File(const std::string &path) :
 	File{path, util::read_file(path)} {
 	// util::read_file throws a FileReadError if unsuccessful.
+	this->reloadable = true;
+}
+
+
+File::File(File &&other) noexcept {
+	*this = std::move(other);
+}
+
+
+File &File::operator=(File &&other) noexcept {
+	if (this == &other) {
+		return *this;
+	}
+
+	// the view has to follow the owned data into this file.
+	bool owned = other.content.data() == other.data.data();
+
+	this->name = std::move(other.name);
+	this->data = std::move(other.data);
+	this->content = owned ? std::string_view{this->data} : other.content;
+	this->line_ends = std::move(other.line_ends);
+	this->reloadable = other.reloadable;
+	this->released = other.released;
+
+	other.content = {};
+	return *this;
+}
+
+
+void File::set_content(std::string_view content) {
+	this->data.clear();
+	this->content = content;
+	this->extract_lines();
 }
 
 
 void File::extract_lines() {
 	this->line_ends = {std::string::npos};
 
-	for (size_t i = 0; i < this->data.size(); i++) {
-		if (this->data[i] == '\n') {
+	for (size_t i = 0; i < this->content.size(); i++) {
+		if (this->content[i] == '\n') {
 			this->line_ends.push_back(i);
 		}
 	}
-	this->line_ends.push_back(data.size());
+	this->line_ends.push_back(this->content.size());
 }
 
 
@@ -39,25 +74,54 @@ const std::string &File::get_name() const {
 }
 
 
-const std::string &File::get_content() const {
-	return this->data;
+std::string_view File::get_content() const {
+	return this->content;
 }
 
 
 std::string File::get_line(size_t n) const {
+	if (this->released) {
+		// the line is only needed for error messages,
+		// so reading the whole file again is fine.
+		try {
+			File reread{this->name};
+			return reread.get_line(n);
+		}
+		catch (FileReadError &) {
+			return {};
+		}
+	}
+
+	if (unlikely(n == 0 or n >= this->line_ends.size())) {
+		return {};
+	}
+
 	size_t begin = this->line_ends[n - 1] + 1;
 	size_t len = this->line_ends[n] - begin;
-	return this->data.substr(begin, len);
+	return std::string{this->content.substr(begin, len)};
 }
 
 
-const char *File::c_str() const {
-	return this->data.c_str();
+size_t File::size() const {
+	return this->content.size();
 }
 
 
-size_t File::size() const {
-	return this->data.size();
+bool File::release_content() {
+	if (not this->reloadable) {
+		return false;
+	}
+
+	this->data = std::string{};
+	this->content = {};
+	this->line_ends = std::vector<size_t>{};
+	this->released = true;
+	return true;
+}
+
+
+bool File::is_released() const {
+	return this->released;
 }
 
 
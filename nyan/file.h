@@ -2,7 +2,9 @@
 #pragma once
 
 
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 
@@ -11,15 +13,17 @@ namespace nyan {
 
 /**
  * Represents a nyan data file.
+ * Files are shared, so that tokens can refer to them
+ * with a plain pointer and create locations from it.
  */
-class File {
+class File : public std::enable_shared_from_this<File> {
 public:
 	File(const std::string &path);
 	File(const std::string &virtual_name, std::string &&data);
 
 	// moving allowed
-	File(File &&other) noexcept = default;
-	File &operator=(File &&other) noexcept = default;
+	File(File &&other) noexcept;
+	File &operator=(File &&other) noexcept;
 
 	// no copies
 	File(const File &other) = delete;
@@ -36,18 +40,22 @@ public:
 
 	/**
 	 * Return the file content.
+	 * The content is not necessarily null-terminated, e.g. for a MappedFile.
 	 *
-	 * @return String containing the file's content.
+	 * @return View on the file's content, valid as long as the file exists.
 	 */
-	const std::string &get_content() const;
+	std::string_view get_content() const;
 
 	/**
 	 * Return the given line number of the file.
 	 * Starts at line 1. *buhuuuuu* *sob* *mrrrmmuu* *whimper*
 	 *
+	 * If the content was released, the file is read again from its path.
+	 *
 	 * @param n Line number.
 	 *
-	 * @return String containing the content of line n.
+	 * @return String containing the content of line n,
+	 *     empty if the line doesn't exist or can't be read.
 	 */
 	std::string get_line(size_t n) const;
 
@@ -61,20 +69,41 @@ public:
 	size_t get_line_count() const;
 
 	/**
-	 * Return a c string of the file content.
+	 * Return the size of the file content.
 	 *
-	 * @return Char array containing the filename.
+	 * @return Size of the file content string (number of characters).
 	 */
-	const char *c_str() const;
+	size_t size() const;
 
 	/**
-	 * Return the size of the file content.
+	 * Drop the content of the file to free its memory.
+	 * Afterwards the content is empty and only get_line() still works,
+	 * by reading the file from disk again.
 	 *
-	 * @return Size of the file content string (number of characters).
+	 * Only files read from a path can be released, virtual files keep
+	 * their content. Must not be called while the content is in use,
+	 * e.g. while the file is parsed.
+	 *
+	 * @return true if the content was released, else false.
 	 */
-	size_t size() const;
+	virtual bool release_content();
+
+	/**
+	 * Check if the content of the file was released.
+	 *
+	 * @return true if release_content() dropped the content, else false.
+	 */
+	bool is_released() const;
 
 protected:
+	/**
+	 * Use content that is not owned by this file, e.g. by a subclass.
+	 * The content must stay valid for the lifetime of the file.
+	 *
+	 * @param content The file content.
+	 */
+	void set_content(std::string_view content);
+
 	/**
 	 * Create line_ends entries from the file content.
 	 */
@@ -86,14 +115,29 @@ protected:
 	std::string name;
 
 	/**
-	 * Content of the file.
+	 * Content of the file if the file owns it.
 	 */
 	std::string data;
 
+	/**
+	 * Content of the file, either the owned data or external memory.
+	 */
+	std::string_view content;
+
 	/**
 	 * Stores the offsets of line endings in the file content.
 	 */
 	std::vector<size_t> line_ends;
+
+	/**
+	 * true if the name is a path the content can be read from again.
+	 */
+	bool reloadable = false;
+
+	/**
+	 * true if the content was released.
+	 */
+	bool released = false;
 };
 
 } // namespace nyan
@@ -12,8 +12,13 @@
 namespace nyan {
 
 
+IDToken::IDToken(std::pmr::memory_resource *resource) :
+	ids{resource} {}
+
+
 IDToken::IDToken(const Token &first,
-                 TokenStream &tokens) {
+                 TokenStream &tokens) :
+	ids{tokens.get_resource()} {
 	this->ids.push_back(first);
 
 	auto token = tokens.next();
@@ -30,11 +35,15 @@ IDToken::IDToken(const Token &first,
 }
 
 
+IDToken::IDToken(const IDToken &other, std::pmr::memory_resource *resource) :
+	ids{other.ids, resource} {}
+
+
 std::string IDToken::str() const {
 	return util::strjoin(
 		".",
 		this->ids,
-		[](const Token &tok) -> auto & {
+		[](const Token &tok) -> std::string_view {
 			return tok.get();
 		});
 }
@@ -55,13 +64,13 @@ token_type IDToken::get_type() const {
 }
 
 
-const Location &IDToken::get_start_location() const {
+Location IDToken::get_start_location() const {
 	if (unlikely(not this->exists())) {
 		throw InternalError{
 			"this IDToken doesn't exist, but you queried its location"};
 	}
 
-	return this->ids.at(0).location;
+	return this->ids.at(0).get_location();
 }
 
 
@@ -73,7 +82,7 @@ size_t IDToken::get_length() const {
 	size_t len = 0;
 	for (auto &tok : this->ids) {
 		// there's separating . in between each id
-		len += tok.location.get_length() + 1;
+		len += tok.get().size() + 1;
 	}
 
 	// there's no trailing . in an id
@@ -83,12 +92,12 @@ size_t IDToken::get_length() const {
 }
 
 
-const std::vector<Token> &IDToken::get_components() const {
+const std::pmr::vector<Token> &IDToken::get_components() const {
 	return this->ids;
 }
 
 
-const std::string &IDToken::get_first() const {
+std::string_view IDToken::get_first() const {
 	if (unlikely(not this->exists())) {
 		throw InternalError{"element of non-existing IDToken requested"};
 	}
@@ -99,7 +108,7 @@ const std::string &IDToken::get_first() const {
 fqon_t IDToken::to_fqon() const {
 	return util::strjoin(".",
 	                     this->ids,
-	                     [](const auto &in) -> const std::string & {
+	                     [](const auto &in) -> std::string_view {
 							 return in.get();
 						 });
 }
@@ -2,6 +2,7 @@
 #pragma once
 
 
+#include <memory_resource>
 #include <string>
 #include <vector>
 
@@ -20,8 +21,32 @@ namespace nyan {
 class IDToken {
 public:
 	IDToken() = default;
+
+	/**
+	 * Create an empty IDToken that allocates from a memory resource.
+	 * Assigning an IDToken from the same resource to it won't copy.
+	 *
+	 * @param resource Memory resource for the token list.
+	 */
+	explicit IDToken(std::pmr::memory_resource *resource);
+
+	/**
+	 * Read an IDToken from a token stream.
+	 * Allocates from the stream's memory resource.
+	 *
+	 * @param first First token of the IDToken.
+	 * @param tokens TokenStream that contains the remaining tokens.
+	 */
 	IDToken(const Token &first, TokenStream &tokens);
 
+	/**
+	 * Copy an IDToken into another memory resource.
+	 *
+	 * @param other IDToken that is copied.
+	 * @param resource Memory resource for the token list.
+	 */
+	IDToken(const IDToken &other, std::pmr::memory_resource *resource);
+
 	/**
 	 * Get the string representation of this IDToken.
 	 *
@@ -48,7 +73,7 @@ public:
 	 *
 	 * @return Location of this IDToken.
 	 */
-	const Location &get_start_location() const;
+	Location get_start_location() const;
 
 	/**
 	 * Get the character length of this IDToken.
@@ -62,14 +87,14 @@ public:
 	 *
 	 * @return A list of Tokens in this IDToken.
 	 */
-	const std::vector<Token> &get_components() const;
+	const std::pmr::vector<Token> &get_components() const;
 
 	/**
 	 * Get the string representation of the first ID in this IDToken.
 	 *
 	 * @return String representation of the first ID formatted in nyan language notation.
 	 */
-	const std::string &get_first() const;
+	std::string_view get_first() const;
 
 	/**
 	 * Get an fqon from an IDToken.
@@ -82,7 +107,7 @@ protected:
 	/**
 	 * List of IDs defining the IDToken.
 	 */
-	std::vector<Token> ids;
+	std::pmr::vector<Token> ids;
 };
 
 
@@ -2,6 +2,9 @@
 
 #include "impl.h"
 
+#include <algorithm>
+#include <cstring>
+
 #define YY_NO_UNISTD_H
 #include "flex.gen.h"
 
@@ -57,6 +60,7 @@ TokenizeError Impl::error(const std::string &msg) {
 
 void Impl::advance_linepos() {
 	this->linepos += yyget_leng(this->scanner);
+	this->offset += yyget_leng(this->scanner);
 }
 
 int Impl::read_input(char *buffer, int max_size) {
@@ -64,8 +68,11 @@ int Impl::read_input(char *buffer, int max_size) {
 		return 0;
 	}
 
-	this->input.read(buffer, static_cast<std::streamsize>(max_size));
-	return static_cast<int>(this->input.gcount());
+	// copy straight from the file content into the flex buffer.
+	size_t count = std::min(this->input.size(), static_cast<size_t>(max_size));
+	std::memcpy(buffer, this->input.data(), count);
+	this->input.remove_prefix(count);
+	return static_cast<int>(count);
 }
 
 void Impl::endline() {
@@ -94,23 +101,14 @@ void Impl::token(token_type type) {
 	// for correct line-wrap-indentation.
 	this->track_brackets(type, token_start);
 
-	if (token_needs_payload(type)) {
-		this->tokens.push(Token{
-			this->file,
-			lineno,
-			token_start,
-			length,
-			type,
-			yyget_text(this->scanner)});
-	}
-	else {
-		this->tokens.push(Token{
-			this->file,
-			lineno,
-			token_start,
-			length,
-			type});
-	}
+	// the payload is referenced in the file content, not copied.
+	this->tokens.push(Token{
+		this->file.get(),
+		lineno,
+		token_start,
+		length,
+		type,
+		this->offset - length});
 }
 
 /*
@@ -185,7 +183,9 @@ void Impl::track_brackets(token_type type, int token_start) {
  * measure the indentation of a line
  */
 void Impl::handle_indent(int depth) {
+	// only the indentation is consumed, the rest is lexed again.
 	this->linepos -= yyget_leng(this->scanner) - depth;
+	this->offset -= yyget_leng(this->scanner) - depth;
 
 	if (not this->brackets.empty()) {
 		// we're in a pair of brackets,
@@ -3,6 +3,7 @@
 
 #include <queue>
 #include <stack>
+#include <string_view>
 
 #include "../lang_error.h"
 #include "bracket.h"
@@ -67,8 +68,8 @@ protected:
 	/** Input file used for tokenization. */
 	std::shared_ptr<File> file;
 
-	/** String stream which is fed into the lexer. */
-	std::istringstream input;
+	/** Not yet lexed part of the file content, fed into the lexer. */
+	std::string_view input;
 
 	/** Available tokens. */
 	std::queue<Token> tokens;
@@ -99,6 +100,9 @@ protected:
 	/** Current position in a line. */
 	int linepos = linepos_start;
 
+	/** Current position in the file content. */
+	size_t offset = 0;
+
 	/** yyscan_t object: pointer to flex generated lexer */
 	void *scanner{nullptr};
 };
@@ -0,0 +1,54 @@
+// Copyright 2026-2026 the nyan authors, LGPLv3+. See copying.md for legal info.
+
+#include "lineage.h"
+
+#include <algorithm>
+
+#include "compiler.h"
+#include "error.h"
+#include "meta_info.h"
+#include "object_state.h"
+
+
+namespace nyan {
+
+Lineage::Lineage(const std::vector<fqon_t> &linearization,
+                 const MetaInfo &meta_info,
+                 const obj_state_func_t &get_obj) {
+	this->ancestors.reserve(linearization.size());
+
+	for (auto &obj : linearization) {
+		const symbol_t *obj_symbol = meta_info.get_object_symbol(obj);
+		if (unlikely(obj_symbol == nullptr)) {
+			throw InternalError{"linearization object not in database"};
+		}
+
+		this->ancestors.push_back(*obj_symbol);
+
+		for (auto &it : get_obj(*obj_symbol).get_members()) {
+			this->members.push_back(it.first);
+		}
+	}
+
+	// the linearization has no duplicates, but members are
+	// usually defined in more than one object of it.
+	std::sort(std::begin(this->ancestors), std::end(this->ancestors));
+	std::sort(std::begin(this->members), std::end(this->members));
+	this->members.erase(
+		std::unique(std::begin(this->members), std::end(this->members)),
+		std::end(this->members)
+	);
+	this->members.shrink_to_fit();
+}
+
+
+bool Lineage::extends(symbol_t obj) const {
+	return std::binary_search(std::begin(this->ancestors), std::end(this->ancestors), obj);
+}
+
+
+bool Lineage::has_member(symbol_t member) const {
+	return std::binary_search(std::begin(this->members), std::end(this->members), member);
+}
+
+} // namespace nyan
@@ -0,0 +1,73 @@
+// Copyright 2026-2026 the nyan authors, LGPLv3+. See copying.md for legal info.
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "config.h"
+
+
+namespace nyan {
+
+class MetaInfo;
+class ObjectState;
+
+
+/**
+ * Precomputed inheritance facts of an object, derived from its linearization.
+ * Answers which objects it extends and which members it has
+ * by bisection. Its size only depends on the object's own ancestors and members.
+ * Has to be recreated whenever the object is relinearized.
+ */
+class Lineage {
+public:
+	/**
+	 * Function to retrieve the state of an object in the linearization.
+	 */
+	using obj_state_func_t = std::function<const ObjectState &(symbol_t)>;
+
+	Lineage() = default;
+
+	/**
+	 * Create the lineage for a linearization.
+	 *
+	 * @param linearization C3 linearization of the object.
+	 * @param meta_info Metadata information of the database.
+	 * @param get_obj Function to retrieve the object states of the linearization.
+	 */
+	Lineage(const std::vector<fqon_t> &linearization,
+	        const MetaInfo &meta_info,
+	        const obj_state_func_t &get_obj);
+
+	/**
+	 * Check if an object is in the linearization.
+	 *
+	 * @param obj Symbol of the object identifier.
+	 *
+	 * @return true if the object is the object itself or one of its ancestors, else false.
+	 */
+	bool extends(symbol_t obj) const;
+
+	/**
+	 * Check if any object in the linearization has a member.
+	 *
+	 * @param member Symbol of the member identifier.
+	 *
+	 * @return true if the member exists in the linearization, else false.
+	 */
+	bool has_member(symbol_t member) const;
+
+protected:
+	/**
+	 * Sorted object symbols in the linearization.
+	 */
+	std::vector<symbol_t> ancestors;
+
+	/**
+	 * Sorted, unique member symbols of all objects in the linearization.
+	 */
+	std::vector<symbol_t> members;
+};
+
+
+} // namespace nyan
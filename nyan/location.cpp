@@ -11,7 +11,7 @@ namespace nyan {
 
 
 Location::Location(const Token &token) :
-	Location{token.location} {}
+	Location{token.get_location()} {}
 
 
 Location::Location(const IDToken &token) :
@@ -0,0 +1,116 @@
+// Copyright 2026-2026 the nyan authors, LGPLv3+. See copying.md for legal info.
+
+#include "mapped_file.h"
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+	#define NYAN_HAVE_MMAP
+#endif
+
+#include "compiler.h"
+#include "error.h"
+#include "util.h"
+
+
+namespace nyan {
+
+namespace {
+
+/**
+ * Create the error for a failed operation on a file.
+ */
+FileReadError file_error(const std::string &what, const std::string &path) {
+	std::ostringstream builder;
+	builder << "failed " << what << " file '"
+	        << path << "': "
+	        << strerror(errno);
+	return FileReadError{builder.str()};
+}
+
+} // namespace
+
+
+MappedFile::MappedFile(const std::string &path) :
+	File{path, std::string{}} {
+	this->reloadable = true;
+
+#ifdef NYAN_HAVE_MMAP
+	int fd = open(path.c_str(), O_RDONLY);
+	if (unlikely(fd < 0)) {
+		throw file_error("opening", path);
+	}
+
+	struct stat info;
+	if (unlikely(fstat(fd, &info) < 0)) {
+		auto error = file_error("inspecting", path);
+		close(fd);
+		throw error;
+	}
+
+	this->mapping_size = static_cast<size_t>(info.st_size);
+
+	// empty files can't be mapped, and they have no content anyway.
+	if (this->mapping_size > 0) {
+		void *mem = mmap(nullptr, this->mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (unlikely(mem == MAP_FAILED)) {
+			auto error = file_error("mapping", path);
+			close(fd);
+			throw error;
+		}
+		this->mapping = mem;
+
+		// the file is read front to back by the lexer.
+		madvise(this->mapping, this->mapping_size, MADV_SEQUENTIAL);
+	}
+
+	// the mapping stays valid without the descriptor.
+	close(fd);
+
+	this->set_content({static_cast<const char *>(this->mapping), this->mapping_size});
+#else
+	this->data = util::read_file(path);
+	this->content = this->data;
+	this->extract_lines();
+#endif
+}
+
+
+MappedFile::~MappedFile() {
+#ifdef NYAN_HAVE_MMAP
+	if (this->mapping != nullptr) {
+		munmap(this->mapping, this->mapping_size);
+	}
+#endif
+}
+
+
+bool MappedFile::release_content() {
+	File::release_content();
+
+#ifdef NYAN_HAVE_MMAP
+	if (this->mapping != nullptr) {
+		munmap(this->mapping, this->mapping_size);
+		this->mapping = nullptr;
+		this->mapping_size = 0;
+	}
+#endif
+
+	return true;
+}
+
+
+std::function<std::shared_ptr<File>(const std::string &)>
+MappedFile::fetcher(const std::string &base_path) {
+	return [base_path](const std::string &filename) -> std::shared_ptr<File> {
+		return std::make_shared<MappedFile>(base_path + "/" + filename);
+	};
+}
+
+} // namespace nyan
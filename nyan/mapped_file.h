@@ -0,0 +1,69 @@
+// Copyright 2026-2026 the nyan authors, LGPLv3+. See copying.md for legal info.
+#pragma once
+
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "file.h"
+
+
+namespace nyan {
+
+
+/**
+ * A nyan data file whose content is mapped into memory
+ * instead of being read into a string.
+ *
+ * On platforms without mmap, the content is read like for a File.
+ */
+class MappedFile : public File {
+public:
+	/**
+	 * Map the file at the given path.
+	 * Throws a FileReadError if the file can't be opened or mapped.
+	 *
+	 * @param path Path of the file.
+	 */
+	explicit MappedFile(const std::string &path);
+
+	// the mapping is owned by exactly one file.
+	MappedFile(MappedFile &&other) = delete;
+	MappedFile &operator=(MappedFile &&other) = delete;
+	MappedFile(const MappedFile &other) = delete;
+	MappedFile &operator=(const MappedFile &other) = delete;
+
+	~MappedFile() override;
+
+	/**
+	 * Unmap the file content, see File::release_content().
+	 *
+	 * @return true as the mapped file can always be read again.
+	 */
+	bool release_content() override;
+
+	/**
+	 * Create a filefetcher for Database::load that maps
+	 * the requested files relative to a base path.
+	 *
+	 * @param base_path Directory the requested filenames are relative to.
+	 *
+	 * @return Function that maps the file for a given filename.
+	 */
+	static std::function<std::shared_ptr<File>(const std::string &)>
+	fetcher(const std::string &base_path);
+
+protected:
+	/**
+	 * Start of the mapped memory, nullptr if nothing is mapped.
+	 */
+	void *mapping = nullptr;
+
+	/**
+	 * Size of the mapped memory.
+	 */
+	size_t mapping_size = 0;
+};
+
+} // namespace nyan
@@ -19,6 +19,8 @@ namespace nyan {
  * Also responsible for validating applied operators.
  */
 class Member {
+	friend class Snapshot;
+
 public:
 	/**
 	 * Member with value.
@@ -0,0 +1,39 @@
+// Copyright 2026-2026 the nyan authors, LGPLv3+. See copying.md for legal info.
+
+#include "member_handle.h"
+
+#include "type.h"
+
+
+namespace nyan {
+
+MemberHandle::MemberHandle(symbol_t symbol,
+                           const memberid_t &name,
+                           const fqon_t &definer,
+                           const std::shared_ptr<Type> &type) :
+	symbol{symbol},
+	name{name},
+	definer{definer},
+	type{type} {}
+
+
+symbol_t MemberHandle::get_symbol() const {
+	return this->symbol;
+}
+
+
+const memberid_t &MemberHandle::get_name() const {
+	return this->name;
+}
+
+
+const fqon_t &MemberHandle::get_definer() const {
+	return this->definer;
+}
+
+
+const Type &MemberHandle::get_type() const {
+	return *this->type;
+}
+
+} // namespace nyan
@@ -0,0 +1,80 @@
+// Copyright 2026-2026 the nyan authors, LGPLv3+. See copying.md for legal info.
+#pragma once
+
+#include <memory>
+
+#include "config.h"
+
+
+namespace nyan {
+
+class Type;
+
+
+/**
+ * Pre-resolved reference to a member.
+ * Obtain it once with Database::member_handle() and use it for repeated
+ * value queries, which then skip the lookup of the member name.
+ *
+ * A handle is only valid for objects of the database that created it.
+ */
+class MemberHandle {
+public:
+	MemberHandle(symbol_t symbol,
+	             const memberid_t &name,
+	             const fqon_t &definer,
+	             const std::shared_ptr<Type> &type);
+
+	/**
+	 * Get the interned symbol of the member, which is the
+	 * key of the member in all object states.
+	 *
+	 * @return Symbol of the member identifier.
+	 */
+	symbol_t get_symbol() const;
+
+	/**
+	 * Get the identifier of the member.
+	 *
+	 * @return Member identifier.
+	 */
+	const memberid_t &get_name() const;
+
+	/**
+	 * Get the object that initially defines the member type.
+	 *
+	 * @return Identifier of the defining object.
+	 */
+	const fqon_t &get_definer() const;
+
+	/**
+	 * Get the type of the member.
+	 *
+	 * @return Type of the member.
+	 */
+	const Type &get_type() const;
+
+protected:
+	/**
+	 * Symbol of the member identifier.
+	 */
+	symbol_t symbol;
+
+	/**
+	 * Identifier of the member.
+	 */
+	memberid_t name;
+
+	/**
+	 * Identifier of the object that defines the member type.
+	 */
+	fqon_t definer;
+
+	/**
+	 * Type of the member.
+	 */
+	std::shared_ptr<Type> type;
+};
+
+
+} // namespace nyan
@@ -5,24 +5,31 @@
 #include <sstream>
 #include <utility>
 
+#include "compiler.h"
+#include "error.h"
 #include "lang_error.h"
 
 
 namespace nyan {
 
 ObjectInfo &MetaInfo::add_object(const fqon_t &name, ObjectInfo &&obj_info) {
-	// copy location so we can use it after obj was moved.
-	Location loc = obj_info.get_location();
-
-	auto ret = this->object_info.insert({name, std::move(obj_info)});
-	if (ret.second == false) {
+	const symbol_t *existing = this->object_symbols.find(name);
+	if (existing != nullptr) {
 		throw LangError{
-			loc,
+			obj_info.get_location(),
 			"object already defined",
-			{{ret.first->second.get_location(), "first defined here"}}};
+			{{this->object_info[*existing].get_location(), "first defined here"}}};
 	}
 
-	return ret.first->second;
+	symbol_t symbol = this->object_symbols.intern(name);
+	if (unlikely(symbol != this->object_info.size())) {
+		throw InternalError{"object symbols out of sync with object infos"};
+	}
+
+	// the symbol table doesn't move its names.
+	ObjectInfo &ret = this->object_info.emplace_back(std::move(obj_info));
+	ret.name = &this->object_symbols.get_name(symbol);
+	return ret;
 }
 
 
@@ -31,22 +38,50 @@ const MetaInfo::obj_info_t &MetaInfo::get_objects() const {
 }
 
 
+const symbol_t *MetaInfo::get_object_symbol(const fqon_t &name) const {
+	return this->object_symbols.find(name);
+}
+
+
+const SymbolTable &MetaInfo::get_object_symbols() const {
+	return this->object_symbols;
+}
+
+
+SymbolTable &MetaInfo::get_member_symbols() {
+	return this->member_symbols;
+}
+
+
+const SymbolTable &MetaInfo::get_member_symbols() const {
+	return this->member_symbols;
+}
+
+
 ObjectInfo *MetaInfo::get_object(const fqon_t &name) {
 	return const_cast<ObjectInfo *>(std::as_const(*this).get_object(name));
 }
 
 
 const ObjectInfo *MetaInfo::get_object(const fqon_t &name) const {
-	auto it = this->object_info.find(name);
-	if (it == std::end(this->object_info)) {
+	const symbol_t *symbol = this->object_symbols.find(name);
+	if (symbol == nullptr) {
 		return nullptr;
 	}
-	return &it->second;
+	return &this->object_info[*symbol];
+}
+
+
+const ObjectInfo &MetaInfo::get_object(symbol_t symbol) const {
+	if (unlikely(symbol >= this->object_info.size())) {
+		throw InternalError{"object symbol not in metainfo"};
+	}
+	return this->object_info[symbol];
 }
 
 
 bool MetaInfo::has_object(const fqon_t &name) const {
-	return this->object_info.count(name) == 1;
+	return this->object_symbols.find(name) != nullptr;
 }
 
 Namespace &MetaInfo::add_namespace(const Namespace &ns) {
@@ -55,6 +90,10 @@ Namespace &MetaInfo::add_namespace(const Namespace &ns) {
 	return ret.first->second;
 }
 
+const MetaInfo::ns_info_t &MetaInfo::get_namespaces() const {
+	return this->namespaces;
+}
+
 Namespace *MetaInfo::get_namespace(const fqnn_t &name) {
 	return const_cast<Namespace *>(std::as_const(*this).get_namespace(name));
 }
@@ -74,8 +113,9 @@ bool MetaInfo::has_namespace(const fqnn_t &name) const {
 std::string MetaInfo::str() const {
 	std::ostringstream builder;
 
-	for (auto &it : this->get_objects()) {
-		builder << it.first << " -> " << it.second.str() << std::endl;
+	for (symbol_t sym = 0; sym < this->object_info.size(); sym++) {
+		builder << this->object_symbols.get_name(sym)
+		        << " -> " << this->object_info[sym].str() << std::endl;
 	}
 
 	return builder.str();
@@ -1,6 +1,7 @@
 // Copyright 2017-2023 the nyan authors, LGPLv3+. See copying.md for legal info.
 #pragma once
 
+#include <deque>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -8,6 +9,7 @@
 #include "config.h"
 #include "namespace.h"
 #include "object_info.h"
+#include "symbol_table.h"
 
 
 namespace nyan {
@@ -18,7 +20,7 @@ namespace nyan {
  */
 class MetaInfo {
 public:
-	using obj_info_t = std::unordered_map<fqon_t, ObjectInfo>;
+	using obj_info_t = std::deque<ObjectInfo>;
 	using ns_info_t = std::unordered_map<fqnn_t, Namespace>;
 
 	MetaInfo() = default;
@@ -26,6 +28,7 @@ public:
 
 	/**
 	 * Add metadata information for an object.
+	 * This creates the symbol of the object.
 	 *
 	 * @param name Identifier of the object.
 	 * @param obj_info ObjectInfo with metadata information.
@@ -38,10 +41,41 @@ public:
 	 * Get the all metadata information objects for objects
 	 * stored in the database.
 	 *
-	 * @return Map of metadata information objects by object identifier.
+	 * @return Metadata information objects indexed by object symbol,
+	 *     ObjectInfo::get_name() returns their identifiers.
 	 */
 	const obj_info_t &get_objects() const;
 
+	/**
+	 * Get the symbol of an object.
+	 *
+	 * @param name Identifier of the object.
+	 *
+	 * @return Pointer to the symbol if the object is in the database, else nullptr.
+	 */
+	const symbol_t *get_object_symbol(const fqon_t &name) const;
+
+	/**
+	 * Get the symbols of all objects in the database.
+	 *
+	 * @return Symbol table for object identifiers.
+	 */
+	const SymbolTable &get_object_symbols() const;
+
+	/**
+	 * Get the symbols of all member names in the database.
+	 *
+	 * @return Symbol table for member identifiers.
+	 */
+	SymbolTable &get_member_symbols();
+
+	/**
+	 * Get the symbols of all member names in the database.
+	 *
+	 * @return Symbol table for member identifiers.
+	 */
+	const SymbolTable &get_member_symbols() const;
+
 	/**
 	 * Get the the metadata information object for an object.
 	 *
@@ -62,6 +96,15 @@ public:
 	 */
 	const ObjectInfo *get_object(const fqon_t &name) const;
 
+	/**
+	 * Get the the metadata information object for an object.
+	 *
+	 * @param symbol Symbol of the object.
+	 *
+	 * @return ObjectInfo with metadata information of the object.
+	 */
+	const ObjectInfo &get_object(symbol_t symbol) const;
+
 	/**
 	 * Check if an object is in the database.
 	 *
@@ -98,6 +141,13 @@ public:
 	 */
 	const Namespace *get_namespace(const fqnn_t &name) const;
 
+	/**
+	 * Get all namespaces in the database.
+	 *
+	 * @return Map of namespace identifiers to namespaces.
+	 */
+	const ns_info_t &get_namespaces() const;
+
 	/**
 	 * Check if a namespace is in the database.
 	 *
@@ -121,6 +171,16 @@ protected:
 	 */
 	obj_info_t object_info;
 
+	/**
+	 * Symbols of the objects, the symbol is the index in object_info.
+	 */
+	SymbolTable object_symbols;
+
+	/**
+	 * Symbols of the member names of all objects.
+	 */
+	SymbolTable member_symbols;
+
 	/**
 	 * Namespaces loaded in the database.
 	 */
@@ -74,7 +74,7 @@ fqon_t Namespace::combine(const IDToken &name, size_t skip) const {
 			skip -= 1;
 		}
 		else {
-			combined.obj_components.push_back(part.get());
+			combined.obj_components.emplace_back(part.get());
 		}
 	}
 
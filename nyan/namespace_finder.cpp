@@ -21,7 +21,7 @@ void NamespaceFinder::add_import(const Namespace &import) {
 
 void NamespaceFinder::add_alias(const Token &alias,
                                 const Namespace &destination) {
-	const std::string &search = alias.get();
+	std::string search{alias.get()};
 
 	if (this->aliases.find(search) != std::end(this->aliases)) {
 		throw NameError{alias, "redefinition of namespace alias", search};
@@ -46,7 +46,7 @@ fqon_t NamespaceFinder::expand_alias(const IDToken &name) const {
 	}
 
 	// only the first component can be an alias.
-	const std::string &first = name.get_components()[0].get();
+	std::string first{name.get_components()[0].get()};
 
 	auto it = this->aliases.find(first);
 	if (it != std::end(this->aliases)) {
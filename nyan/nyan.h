@@ -15,7 +15,9 @@
 #include "error.h"
 #include "file.h"
 #include "lexer/lexer.h"
+#include "mapped_file.h"
 #include "member.h"
+#include "member_handle.h"
 #include "namespace.h"
 #include "object.h"
 #include "ops.h"
@@ -2,14 +2,19 @@
 
 #include "nyan_tool.h"
 
+#include <atomic>
+#include <cmath>
 #include <cstdio>
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "nyan.h"
+#include "snapshot.h"
 
 
 namespace nyan {
@@ -18,11 +23,7 @@ int test_parser(const std::string &base_path, const std::string &filename) {
 	int ret = 0;
 	auto db = Database::create();
 
-	db->load(
-		filename,
-		[&base_path](const std::string &filename) {
-			return std::make_shared<File>(base_path + "/" + filename);
-		});
+	db->load(filename, MappedFile::fetcher(base_path));
 
 	std::shared_ptr<View> root = db->new_view();
 
@@ -58,6 +59,36 @@ int test_parser(const std::string &base_path, const std::string &filename) {
 		return 1;
 	}
 
+	// probing members without exceptions
+	if (first.try_get_int("member", 0) != 15) {
+		std::cout << "First.member should be 15 by try_get_int" << std::endl;
+		return 1;
+	}
+
+	std::optional<value_float_t> blob = first.try_get_float("blob", 0);
+	if (not blob.has_value() or not std::isinf(*blob) or *blob > 0) {
+		std::cout << "First.blob should be -inf by try_get_float" << std::endl;
+		return 1;
+	}
+
+	if (first.try_get_int("nonexistent", 0).has_value()
+	    or first.try_get_value("nonexistent", 0).has_value()) {
+		std::cout << "First.nonexistent should not exist" << std::endl;
+		return 1;
+	}
+
+	if (second.try_get<Object>("wat3", 0).has_value()) {
+		std::cout << "Second.wat3 should be None by try_get" << std::endl;
+		return 1;
+	}
+
+	try {
+		first.try_get_int("blob", 0);
+		std::cout << "try_get_int of the float First.blob should fail" << std::endl;
+		return 1;
+	}
+	catch (MemberTypeError &) {}
+
 
 	Object patch = root->get_object("test.FirstPatch");
 	for (int i = 0; i < 3; i++) {
@@ -155,13 +186,407 @@ int test_parser(const std::string &base_path, const std::string &filename) {
 			  << "newvalue = " << root->get_object("test.Test").get_value("new_value", 1)->str()
 			  << std::endl;
 
+	// fetching many members at once equals fetching them one by one
+	std::vector<memberid_t> members{"member", "nice_member", "wat", "wat3", "wat4", "blub"};
+	for (order_t t : {0, 1}) {
+		std::vector<ValueHolder> values = second.get_values(members, t);
+		for (size_t idx = 0; idx < members.size(); idx++) {
+			if (not (values[idx] == second.get_value(members[idx], t))) {
+				std::cout << "Second." << members[idx] << " differs in get_values at t=" << t << std::endl;
+				return 1;
+			}
+		}
+	}
+
+	try {
+		std::vector<memberid_t> missing{"member", "nonexistent"};
+		second.get_values(missing);
+		std::cout << "get_values of Second.nonexistent should fail" << std::endl;
+		return 1;
+	}
+	catch (MemberNotFoundError &) {}
+
+	// one member of many objects, sharing the values of common ancestors
+	std::vector<fqon_t> objects{"test.First", "test.Second", "test.Test", "test.TestChild", "test.NestingBase"};
+	for (order_t t : {0, 1}) {
+		std::vector<ValueHolder> values = root->get_values(objects, "member", t);
+		for (size_t idx = 0; idx < objects.size(); idx++) {
+			if (not (values[idx] == root->get_object(objects[idx]).get_value("member", t))) {
+				std::cout << objects[idx] << ".member differs in View::get_values at t=" << t << std::endl;
+				return 1;
+			}
+		}
+	}
+
 	return ret;
 }
 
 
+/**
+ * Check that a transaction fails to commit with a ConflictError.
+ *
+ * @return true if the transaction conflicted, else false.
+ */
+static bool expect_conflict(Transaction &tx, const std::string &description) {
+	if (tx.commit()) {
+		std::cout << description << ": transaction should conflict" << std::endl;
+		return false;
+	}
+
+	try {
+		std::rethrow_exception(tx.get_exception());
+	}
+	catch (ConflictError &) {
+		return true;
+	}
+	catch (...) {}
+
+	std::cout << description << ": transaction failed without ConflictError" << std::endl;
+	return false;
+}
+
+
+int test_transactions(const std::string &base_path, const std::string &filename) {
+	auto db = Database::create();
+	db->load(filename, MappedFile::fetcher(base_path));
+
+	// each case gets a new view, so they don't see each other's commits.
+	{
+		std::shared_ptr<View> view = db->new_view();
+		Transaction a = view->new_transaction(5);
+		Transaction b = view->new_transaction(5);
+		a.add(view->get_object("test.FirstPatch"));
+		b.add(view->get_object("test.FirstPatch"));
+
+		if (not a.commit()) {
+			std::cout << "first transaction for First should commit" << std::endl;
+			return 1;
+		}
+		if (not expect_conflict(b, "same target at the same time")) {
+			return 1;
+		}
+		if (view->get_object("test.First").get_int("member", 5) != 18) {
+			std::cout << "First.member should be patched once" << std::endl;
+			return 1;
+		}
+	}
+
+	{
+		// b read First, which a changed before b's time.
+		std::shared_ptr<View> view = db->new_view();
+		Transaction a = view->new_transaction(13);
+		Transaction b = view->new_transaction(15);
+		a.add(view->get_object("test.FirstPatch"));
+		b.add(view->get_object("test.FirstPatch"));
+
+		if (not a.commit() or not expect_conflict(b, "target changed earlier")) {
+			return 1;
+		}
+	}
+
+	{
+		// a committed for a later time than b, b would drop it.
+		std::shared_ptr<View> view = db->new_view();
+		Transaction a = view->new_transaction(27);
+		Transaction b = view->new_transaction(25);
+		a.add(view->get_object("test.SetPatch"));
+		b.add(view->get_object("test.FirstPatch"));
+
+		if (not a.commit() or not expect_conflict(b, "later transaction committed")) {
+			return 1;
+		}
+	}
+
+	{
+		// the read and write sets don't overlap
+		std::shared_ptr<View> view = db->new_view();
+		Transaction a = view->new_transaction(30);
+		Transaction b = view->new_transaction(30);
+		a.add(view->get_object("test.FirstPatch"));
+		b.add(view->get_object("test.SetPatch"));
+
+		if (not a.commit() or not b.commit()) {
+			std::cout << "transactions with disjoint objects should commit" << std::endl;
+			return 1;
+		}
+	}
+
+	{
+		// transactions of a child view conflict with the parent view
+		std::shared_ptr<View> view = db->new_view();
+		std::shared_ptr<View> child = view->new_child();
+		Transaction a = view->new_transaction(40);
+		Transaction b = child->new_transaction(40);
+		a.add(view->get_object("test.FirstPatch"));
+		b.add(child->get_object("test.FirstPatch"));
+
+		if (not a.commit() or not expect_conflict(b, "parent view changed the target")) {
+			return 1;
+		}
+	}
+
+	{
+		// transactions filled in several threads at once, which query the view meanwhile.
+		// patches with different targets can all be committed,
+		// for the same target only the first commit succeeds.
+		std::shared_ptr<View> view = db->new_view();
+		std::vector<fqon_t> patches{
+			"test.FirstPatch",
+			"test.SetPatch",
+			"test.Bla.AnotherTest",
+			"test.Bla.Test",
+		};
+
+		for (bool same_target : {false, true}) {
+			order_t t = same_target ? 60 : 50;
+			std::vector<std::optional<Transaction>> transactions(patches.size());
+			std::vector<std::thread> threads;
+
+			for (size_t idx = 0; idx < patches.size(); idx++) {
+				threads.emplace_back([&, idx]() {
+					Transaction tx = view->new_transaction(t);
+					for (int round = 0; round < 20; round++) {
+						view->get_object("test.TestChild").get_int("member", t);
+						view->get_obj_children_all("test.First", t);
+					}
+					tx.add(view->get_object(same_target ? patches[0] : patches[idx]));
+					transactions[idx].emplace(std::move(tx));
+				});
+			}
+
+			for (auto &thread : threads) {
+				thread.join();
+			}
+
+			for (size_t idx = 0; idx < transactions.size(); idx++) {
+				if (same_target and idx > 0) {
+					if (not expect_conflict(*transactions[idx], "concurrent transactions for one target")) {
+						return 1;
+					}
+				}
+				else if (not transactions[idx]->commit()) {
+					std::cout << "concurrent transaction for " << patches[idx] << " should commit" << std::endl;
+					return 1;
+				}
+			}
+		}
+
+		// patched at 50 and at 60
+		if (view->get_object("test.First").get_int("member", 60) != 21) {
+			std::cout << "First.member should be patched twice" << std::endl;
+			return 1;
+		}
+	}
+
+	std::cout << "transactions: OK" << std::endl;
+
+	return 0;
+}
+
+
+int test_view_snapshot(const std::string &base_path, const std::string &filename) {
+	auto db = Database::create();
+	db->load(filename, MappedFile::fetcher(base_path));
+
+	std::shared_ptr<View> view = db->new_view();
+	Transaction patch = view->new_transaction(5);
+	patch.add(view->get_object("test.FirstPatch"));
+	if (not patch.commit()) {
+		std::cout << "patch before the snapshot should commit" << std::endl;
+		return 1;
+	}
+
+	std::shared_ptr<View> snap = view->snapshot();
+	const int64_t member = view->get_object("test.First").get_int("member");
+	const int64_t child_member = view->get_object("test.TestChild").get_int("member");
+	const std::unordered_set<fqon_t> children = view->get_obj_children_all("test.First");
+
+	// the snapshot is read from several threads while the view commits.
+	std::atomic<bool> failed = false;
+	std::vector<std::thread> readers;
+	for (int idx = 0; idx < 4; idx++) {
+		readers.emplace_back([&]() {
+			for (int round = 0; round < 200; round++) {
+				for (order_t t : {DEFAULT_T, order_t{100}, LATEST_T}) {
+					if (snap->get_object("test.First").get_int("member", t) != member
+					    or snap->get_object("test.TestChild").get_int("member", t) != child_member
+					    or snap->get_obj_children_all("test.First", t) != children) {
+						failed = true;
+						return;
+					}
+				}
+			}
+		});
+	}
+
+	for (order_t t = 10; t < 200; t += 10) {
+		Transaction tx = view->new_transaction(t);
+		tx.add(view->get_object("test.FirstPatch"));
+		if (not tx.commit()) {
+			std::cout << "patch at " << t << " should commit" << std::endl;
+			failed = true;
+		}
+	}
+
+	for (auto &reader : readers) {
+		reader.join();
+	}
+
+	if (failed) {
+		std::cout << "snapshot content changed by later commits" << std::endl;
+		return 1;
+	}
+
+	if (view->get_object("test.First").get_int("member") == member
+	    or snap->get_object("test.First").get_int("member") != member) {
+		std::cout << "only the view should see the later commits" << std::endl;
+		return 1;
+	}
+
+	std::cout << "view snapshot: OK" << std::endl;
+
+	return 0;
+}
+
+
+/**
+ * Calculate the value of a member for comparisons.
+ * An error is part of the result, both databases must fail the same way.
+ */
+static std::pair<std::optional<ValueHolder>, std::string>
+snapshot_test_value(const Object &obj, const memberid_t &member) {
+	try {
+		return {obj.get_value(member), ""};
+	}
+	catch (Error &err) {
+		return {std::nullopt, err.str()};
+	}
+}
+
+
+int test_snapshot(const std::string &base_path, const std::string &filename) {
+	auto db = Database::create();
+	db->load(filename, MappedFile::fetcher(base_path));
+
+	std::ostringstream out;
+	db->save_snapshot(out);
+	const std::string data = out.str();
+
+	std::istringstream in{data};
+	std::shared_ptr<Database> restored = Database::load_snapshot(in);
+
+	std::shared_ptr<View> root = db->new_view();
+	std::shared_ptr<View> restored_root = restored->new_view();
+
+	// all objects and their member values must survive the round trip.
+	const MetaInfo &info = db->get_info();
+	if (info.get_objects().size() != restored->get_info().get_objects().size()) {
+		std::cout << "restored database has a different number of objects" << std::endl;
+		return 1;
+	}
+
+	for (auto &obj_info : info.get_objects()) {
+		const fqon_t &name = obj_info.get_name();
+		if (not restored->get_info().has_object(name)) {
+			std::cout << "object " << name << " is missing after restoring" << std::endl;
+			return 1;
+		}
+
+		Object obj = root->get_object(name);
+		Object restored_obj = restored_root->get_object(name);
+
+		if (obj.get_parents() != restored_obj.get_parents()) {
+			std::cout << "parents of " << name << " differ after restoring" << std::endl;
+			return 1;
+		}
+
+		for (auto &member : obj_info.get_members()) {
+			auto [value, error] = snapshot_test_value(obj, member.first);
+			auto [restored_value, restored_error] = snapshot_test_value(restored_obj, member.first);
+
+			bool same = (value.has_value() == restored_value.has_value())
+			            and (not value.has_value() or *value == *restored_value)
+			            and error == restored_error;
+
+			if (not same) {
+				std::cout << "value of " << name << "." << member.first
+				          << " differs after restoring" << std::endl;
+				return 1;
+			}
+		}
+	}
+
+	// values that need special encoding
+	Object first = restored_root->get_object("test.First");
+	if (not first.get<Int>("blub")->is_infinite_positive()) {
+		std::cout << "First.blub should be inf after restoring" << std::endl;
+		return 1;
+	}
+
+	auto blob = first.get<Float>("blob");
+	if (not blob->is_infinite() or blob->is_infinite_positive()) {
+		std::cout << "First.blob should be -inf after restoring" << std::endl;
+		return 1;
+	}
+
+	if (restored_root->get_object("test.SetTest").get<Set>("member")->get().size() != 3) {
+		std::cout << "SetTest.member should have 3 elements after restoring" << std::endl;
+		return 1;
+	}
+
+	if (restored_root->get_object("test.DictTest").get<Dict>("dictmember")->get().size() != 2) {
+		std::cout << "DictTest.dictmember should have 2 entries after restoring" << std::endl;
+		return 1;
+	}
+
+	// the restored database must accept patches like the loaded one.
+	for (auto &view : {root, restored_root}) {
+		Transaction tx = view->new_transaction(1);
+		tx.add(view->get_object("test.FirstPatch"));
+		if (not tx.commit()) {
+			std::cout << "patch transaction failed" << std::endl;
+			return 1;
+		}
+	}
+
+	if (*root->get_object("test.First").get<Int>("member", 1)
+	    != *restored_root->get_object("test.First").get<Int>("member", 1)) {
+		std::cout << "patch result differs after restoring" << std::endl;
+		return 1;
+	}
+
+	// broken snapshots must be rejected
+	std::vector<std::pair<std::string, std::string>> broken{
+		{"empty", ""},
+		{"not a snapshot", "this is no nyan snapshot at all"},
+	};
+	for (size_t size : {size_t{4}, sizeof(Snapshot::magic) + 2, data.size() / 2, data.size() - 1}) {
+		broken.emplace_back("truncated to " + std::to_string(size) + " bytes", data.substr(0, size));
+	}
+
+	for (auto &[description, content] : broken) {
+		std::istringstream broken_in{content};
+		try {
+			Database::load_snapshot(broken_in);
+			std::cout << description << ": snapshot should be rejected" << std::endl;
+			return 1;
+		}
+		catch (SnapshotError &) {}
+	}
+
+	std::cout << "snapshot of " << info.get_objects().size() << " objects, "
+	          << data.size() << " bytes: OK" << std::endl;
+
+	return 0;
+}
+
+
 int run(flags_t flags, params_t params) {
 	try {
-		if (flags[option_flag::TEST_PARSER]) {
+		if (flags[option_flag::TEST_PARSER]
+		    or flags[option_flag::TEST_SNAPSHOT]
+		    or flags[option_flag::TEST_TRANSACTIONS]
+		    or flags[option_flag::TEST_VIEW_SNAPSHOT]) {
 			const std::string &filename = params[option_param::FILE];
 
 			if (filename.size() == 0) {
@@ -178,6 +603,15 @@ int run(flags_t flags, params_t params) {
 			std::string base_path = util::strjoin("/", parts);
 
 			try {
+				if (flags[option_flag::TEST_SNAPSHOT]) {
+					return nyan::test_snapshot(base_path, first_file);
+				}
+				if (flags[option_flag::TEST_TRANSACTIONS]) {
+					return nyan::test_transactions(base_path, first_file);
+				}
+				if (flags[option_flag::TEST_VIEW_SNAPSHOT]) {
+					return nyan::test_view_snapshot(base_path, first_file);
+				}
 				return nyan::test_parser(base_path, first_file);
 			}
 			catch (LangError &err) {
@@ -217,6 +651,9 @@ void help() {
 			  << "-f --file <filename>       -- file to load" << std::endl
 			  << "-b --break                 -- debug-break on error" << std::endl
 			  << "   --test-parser           -- test the parser" << std::endl
+			  << "   --test-snapshot         -- test database snapshots" << std::endl
+			  << "   --test-transactions     -- test concurrent transactions" << std::endl
+			  << "   --test-view-snapshot    -- test reading view snapshots during commits" << std::endl
 			  << "   --echo                  -- print the ast" << std::endl
 			  << "" << std::endl;
 }
@@ -225,7 +662,10 @@ void help() {
 std::pair<flags_t, params_t> argparse(int argc, char **argv) {
 	flags_t flags{
 		{option_flag::ECHO, false},
-		{option_flag::TEST_PARSER, false}};
+		{option_flag::TEST_PARSER, false},
+		{option_flag::TEST_SNAPSHOT, false},
+		{option_flag::TEST_TRANSACTIONS, false},
+		{option_flag::TEST_VIEW_SNAPSHOT, false}};
 
 	params_t params{
 		{option_param::FILE, ""}};
@@ -254,6 +694,15 @@ std::pair<flags_t, params_t> argparse(int argc, char **argv) {
 		else if (arg == "--test-parser") {
 			flags[option_flag::TEST_PARSER] = true;
 		}
+		else if (arg == "--test-snapshot") {
+			flags[option_flag::TEST_SNAPSHOT] = true;
+		}
+		else if (arg == "--test-transactions") {
+			flags[option_flag::TEST_TRANSACTIONS] = true;
+		}
+		else if (arg == "--test-view-snapshot") {
+			flags[option_flag::TEST_VIEW_SNAPSHOT] = true;
+		}
 		else {
 			std::cerr << "Unused argument: " << arg << std::endl;
 		}
@@ -12,7 +12,10 @@ namespace nyan {
  */
 enum class option_flag {
 	ECHO,
-	TEST_PARSER
+	TEST_PARSER,
+	TEST_SNAPSHOT,
+	TEST_TRANSACTIONS,
+	TEST_VIEW_SNAPSHOT
 };
 
 /**
@@ -9,6 +9,7 @@
 #include "compiler.h"
 #include "database.h"
 #include "error.h"
+#include "lineage.h"
 #include "object_info.h"
 #include "object_state.h"
 #include "patch_info.h"
@@ -28,7 +29,8 @@ namespace nyan {
 
 Object::Object(const fqon_t &name, const std::shared_ptr<View> &origin) :
 	origin{origin},
-	name{name} {}
+	name{name},
+	symbol{origin->get_symbol(name)} {}
 
 
 Object::~Object() = default;
@@ -39,13 +41,81 @@ const fqon_t &Object::get_name() const {
 }
 
 
+symbol_t Object::get_symbol() const {
+	return this->symbol;
+}
+
+
 const std::shared_ptr<View> &Object::get_view() const {
 	return this->origin;
 }
 
 
 ValueHolder Object::get_value(const memberid_t &member, order_t t) const {
-	return this->calculate_value(member, t);
+	const symbol_t *member_symbol = this->find_member_symbol(member);
+	if (unlikely(member_symbol == nullptr)) {
+		// no object has a member with this name.
+		throw MemberNotFoundError{this->name, member};
+	}
+
+	return this->get_member_value(*member_symbol, t);
+}
+
+
+ValueHolder Object::get_value(const MemberHandle &member, order_t t) const {
+	if (unlikely(not this->name.size())) {
+		throw InvalidObjectError{};
+	}
+
+	return this->get_member_value(member.get_symbol(), t);
+}
+
+
+std::vector<ValueHolder> Object::get_values(std::span<const memberid_t> members, order_t t) const {
+	std::vector<ValueHolder> ret;
+	ret.reserve(members.size());
+
+	// shared by all calculations, fetched when the first value isn't cached.
+	const std::vector<fqon_t> *linearization = nullptr;
+	std::vector<std::shared_ptr<ObjectState>> parents;
+
+	for (auto &member : members) {
+		const symbol_t *member_symbol = this->find_member_symbol(member);
+		if (unlikely(member_symbol == nullptr)) {
+			throw MemberNotFoundError{this->name, member};
+		}
+
+		std::optional<ValueHolder> cached = this->origin->get_cached_value(this->symbol, *member_symbol, t);
+		if (cached.has_value()) {
+			// the cached value is shared, the caller gets its own.
+			ret.push_back((*cached)->copy());
+			continue;
+		}
+
+		if (linearization == nullptr) {
+			linearization = &this->get_linearized(t);
+		}
+
+		std::optional<ValueHolder> result = this->try_calculate_value(*member_symbol, *linearization, &parents, t);
+		if (unlikely(not result.has_value())) {
+			throw MemberNotFoundError{this->name, member};
+		}
+
+		this->origin->cache_value(this->symbol, *member_symbol, t, *result);
+		ret.push_back((*result)->copy());
+	}
+
+	return ret;
+}
+
+
+std::optional<ValueHolder> Object::try_get_value(const memberid_t &member, order_t t) const {
+	const symbol_t *member_symbol = this->find_member_symbol(member);
+	if (member_symbol == nullptr) {
+		return {};
+	}
+
+	return this->try_get_member_value(*member_symbol, t);
 }
 
 
@@ -59,6 +129,34 @@ value_float_t Object::get_float(const memberid_t &member, order_t t) const {
 }
 
 
+value_int_t Object::get_int(const MemberHandle &member, order_t t) const {
+	return this->get_number<Int>(member, t);
+}
+
+
+value_float_t Object::get_float(const MemberHandle &member, order_t t) const {
+	return this->get_number<Float>(member, t);
+}
+
+
+std::optional<value_int_t> Object::try_get_int(const memberid_t &member, order_t t) const {
+	auto value = this->try_get<Int>(member, t);
+	if (not value.has_value()) {
+		return {};
+	}
+	return **value;
+}
+
+
+std::optional<value_float_t> Object::try_get_float(const memberid_t &member, order_t t) const {
+	auto value = this->try_get<Float>(member, t);
+	if (not value.has_value()) {
+		return {};
+	}
+	return **value;
+}
+
+
 std::string Object::get_text(const memberid_t &member, order_t t) const {
 	return *this->get<Text>(member, t);
 }
@@ -107,6 +205,19 @@ std::shared_ptr<Object> Object::get<Object>(const memberid_t &member, order_t t)
 }
 
 
+template <>
+std::shared_ptr<Object> Object::get<Object>(const MemberHandle &member, order_t t) const {
+	auto obj_val = this->get<ObjectValue>(member, t);
+
+	const fqon_t &fqon = obj_val->get_name();
+	std::shared_ptr<Object> ret = std::make_shared<Object>(
+		Object::Restricted{},
+		fqon,
+		this->origin);
+	return ret;
+}
+
+
 template <>
 std::optional<std::shared_ptr<Object>> Object::get_optional<Object>(const memberid_t &member, order_t t) const {
 	auto optional_obj_val = this->get_optional<ObjectValue>(member, t);
@@ -124,16 +235,108 @@ std::optional<std::shared_ptr<Object>> Object::get_optional<Object>(const member
 }
 
 
-ValueHolder Object::calculate_value(const memberid_t &member, order_t t) const {
-	using namespace std::string_literals;
+template <>
+std::optional<std::shared_ptr<Object>> Object::get_optional<Object>(const MemberHandle &member, order_t t) const {
+	auto optional_obj_val = this->get_optional<ObjectValue>(member, t);
+	if (not optional_obj_val.has_value()) {
+		return {};
+	}
+	std::shared_ptr<ObjectValue> obj_val = std::move(optional_obj_val).value();
 
-	// TODO: don't allow calculating values for patches?
-	// it's impossible as they may have members without =
+	const fqon_t &fqon = obj_val->get_name();
+	std::shared_ptr<Object> ret = std::make_shared<Object>(
+		Object::Restricted{},
+		fqon,
+		this->origin);
+	return ret;
+}
+
+
+template <>
+std::optional<std::shared_ptr<Object>> Object::try_get<Object>(const memberid_t &member, order_t t) const {
+	auto optional_obj_val = this->try_get<ObjectValue>(member, t);
+	if (not optional_obj_val.has_value()) {
+		return {};
+	}
+	std::shared_ptr<ObjectValue> obj_val = std::move(optional_obj_val).value();
+
+	const fqon_t &fqon = obj_val->get_name();
+	std::shared_ptr<Object> ret = std::make_shared<Object>(
+		Object::Restricted{},
+		fqon,
+		this->origin);
+	return ret;
+}
+
+
+const symbol_t *Object::find_member_symbol(const memberid_t &member) const {
+	if (unlikely(not this->name.size())) {
+		throw InvalidObjectError{};
+	}
+
+	return this->origin->get_database().get_info().get_member_symbols().find(member);
+}
+
+
+ValueHolder Object::get_member_value(symbol_t member, order_t t) const {
+	// the cached value is shared, the caller gets its own.
+	std::optional<ValueHolder> cached = this->origin->get_cached_value(this->symbol, member, t);
+	if (cached.has_value()) {
+		return (*cached)->copy();
+	}
+
+	ValueHolder result = this->calculate_value(member, t);
+	this->origin->cache_value(this->symbol, member, t, result);
+	return result->copy();
+}
+
+
+std::optional<ValueHolder> Object::try_get_member_value(symbol_t member, order_t t) const {
+	// the cached value is shared, the caller gets its own.
+	std::optional<ValueHolder> cached = this->origin->get_cached_value(this->symbol, member, t);
+	if (cached.has_value()) {
+		return (*cached)->copy();
+	}
+
+	std::optional<ValueHolder> result = this->try_calculate_value(member, t);
+	if (result.has_value()) {
+		this->origin->cache_value(this->symbol, member, t, *result);
+		return (*result)->copy();
+	}
+	return result;
+}
+
+
+ValueHolder Object::calculate_value(symbol_t member, order_t t) const {
+	std::optional<ValueHolder> result = this->try_calculate_value(member, t);
+
+	// no operator = was found for this member
+	// -> no parent assigned a value.
+	// errors in the data files are detected at load time already.
+	if (unlikely(not result.has_value())) {
+		throw MemberNotFoundError{
+			this->name,
+			this->origin->get_database().get_info().get_member_symbols().get_name(member)};
+	}
+
+	return std::move(result).value();
+}
 
+
+std::optional<ValueHolder> Object::try_calculate_value(symbol_t member, order_t t) const {
 	// get references to all parentobject-states
 	std::vector<std::shared_ptr<ObjectState>> parents;
 
-	const std::vector<fqon_t> &linearization = this->get_linearized(t);
+	return this->try_calculate_value(member, this->get_linearized(t), &parents, t);
+}
+
+
+std::optional<ValueHolder> Object::try_calculate_value(symbol_t member,
+                                                       const std::vector<fqon_t> &linearization,
+                                                       std::vector<std::shared_ptr<ObjectState>> *parents,
+                                                       order_t t) const {
+	// TODO: don't allow calculating values for patches?
+	// it's impossible as they may have members without =
 
 	// find the last value assigning with =
 	// it sets the base value where we apply the modifications then
@@ -141,8 +344,11 @@ ValueHolder Object::calculate_value(const memberid_t &member, order_t t) const {
 
 	const Value *base_value = nullptr;
 	for (auto &obj : linearization) {
-		parents.push_back(this->origin->get_raw(obj, t));
-		const ObjectState *obj_raw = parents.back().get();
+		// only fetch the parent states no previous calculation needed
+		if (defined_by == parents->size()) {
+			parents->push_back(this->origin->get_raw(obj, t));
+		}
+		const ObjectState *obj_raw = (*parents)[defined_by].get();
 		const Member *obj_member = obj_raw->get(member);
 		// if the object has the member, check if it's the =
 		if (obj_member != nullptr) {
@@ -155,10 +361,8 @@ ValueHolder Object::calculate_value(const memberid_t &member, order_t t) const {
 	}
 
 	// no operator = was found for this member
-	// -> no parent assigned a value.
-	// errors in the data files are detected at load time already.
-	if (unlikely(defined_by >= linearization.size() or base_value == nullptr)) {
-		throw MemberNotFoundError{this->name, member};
+	if (defined_by >= linearization.size() or base_value == nullptr) {
+		return {};
 	}
 
 	// if this object defines the value, no aggregation is needed.
@@ -175,7 +379,7 @@ ValueHolder Object::calculate_value(const memberid_t &member, order_t t) const {
 	// this prevents reassignment errors e.g. from assigning None
 	int parent_idx = defined_by - 1;
 	while (parent_idx >= 0) {
-		const Member *change = parents[parent_idx]->get(member);
+		const Member *change = (*parents)[parent_idx]->get(member);
 		if (change != nullptr) {
 			result->apply(*change);
 		}
@@ -196,17 +400,12 @@ bool Object::has(const memberid_t &member, order_t t) const {
 }
 
 bool Object::has_member(const memberid_t &member, order_t t) const {
-	// TODO: cache?
-
-	const std::vector<fqon_t> &lin = this->get_linearized(t);
-
-	for (auto &obj : lin) {
-		if (this->origin->get_raw(obj, t)->get(member) != nullptr) {
-			return true;
-		}
+	const symbol_t *member_symbol = this->find_member_symbol(member);
+	if (member_symbol == nullptr) {
+		return false;
 	}
 
-	return false;
+	return this->get_lineage(t).has_member(*member_symbol);
 }
 
 
@@ -215,17 +414,13 @@ bool Object::extends(const fqon_t &other_fqon, order_t t) const {
 		return true;
 	}
 
-	// TODO cache?
-
-	auto &linearization = this->get_linearized(t);
-
-	for (auto &obj : linearization) {
-		if (obj == other_fqon) {
-			return true;
-		}
+	const symbol_t *other_symbol = this->origin->get_database().get_info().get_object_symbol(other_fqon);
+	if (other_symbol == nullptr) {
+		// objects outside the database can't be parents.
+		return false;
 	}
 
-	return false;
+	return this->get_lineage(t).extends(*other_symbol);
 }
 
 
@@ -234,11 +429,7 @@ const ObjectInfo &Object::get_info() const {
 		throw InvalidObjectError{};
 	}
 
-	const ObjectInfo *ret = this->origin->get_database().get_info().get_object(this->get_name());
-	if (unlikely(ret == nullptr)) {
-		throw InternalError{"object info unavailable for object handle"};
-	}
-	return *ret;
+	return this->origin->get_database().get_info().get_object(this->symbol);
 }
 
 
@@ -262,9 +453,11 @@ const std::vector<fqon_t> &Object::get_linearized(order_t t) const {
 		throw InvalidObjectError{};
 	}
 
-	return this->origin->get_linearization(this->name, t);
+	return this->origin->get_linearization(this->symbol, t);
 }
 
+
+
 std::shared_ptr<ObjectNotifier>
 Object::subscribe(const update_cb_t &callback) {
 	if (unlikely(not this->name.size())) {
@@ -280,7 +473,16 @@ const std::shared_ptr<ObjectState> &Object::get_raw(order_t t) const {
 		throw InvalidObjectError{};
 	}
 
-	return this->origin->get_raw(this->name, t);
+	return this->origin->get_raw(this->symbol, t);
+}
+
+
+const Lineage &Object::get_lineage(order_t t) const {
+	if (unlikely(not this->name.size())) {
+		throw InvalidObjectError{};
+	}
+
+	return this->origin->get_lineage(this->symbol, t);
 }
 
 } // namespace nyan
@@ -4,6 +4,8 @@
 
 #include <deque>
 #include <memory>
+#include <optional>
+#include <span>
 #include <sstream>
 #include <unordered_map>
 #include <unordered_set>
@@ -12,6 +14,7 @@
 #include "api_error.h"
 #include "concept.h"
 #include "config.h"
+#include "member_handle.h"
 #include "object_notifier_types.h"
 #include "util.h"
 #include "value/container_types.h"
@@ -22,6 +25,7 @@
 namespace nyan {
 
 class NumberBase;
+class Lineage;
 class Object;
 class ObjectInfo;
 class ObjectState;
@@ -65,6 +69,13 @@ public:
 	 */
 	const fqon_t &get_name() const;
 
+	/**
+	 * Get the interned symbol of this object's identifier.
+	 *
+	 * @return Symbol of this object.
+	 */
+	symbol_t get_symbol() const;
+
 	/**
 	 * Get the view of the database this object is associated with
 	 *
@@ -73,9 +84,12 @@ public:
 	const std::shared_ptr<View> &get_view() const;
 
 	/**
-	 * Get a new value holder that contains the calculated member value
+	 * Get a value holder that contains the calculated member value
 	 * for a given member at a given time.
 	 *
+	 * Calculated values are cached in the view. The returned value
+	 * is a copy of the cached one, so the caller may modify it.
+	 *
 	 * @param member Member ID.
 	 * @param t Time for which we want to calculate the value.
 	 *
@@ -83,6 +97,22 @@ public:
 	 */
 	ValueHolder get_value(const memberid_t &member, order_t t = LATEST_T) const;
 
+	/**
+	 * Get value holders that contain the calculated member values
+	 * for multiple members at a given time.
+	 *
+	 * Equivalent to calling get_value() for each member, but the
+	 * linearization and the states of the parents are fetched only
+	 * once for all members.
+	 *
+	 * @param members Member IDs.
+	 * @param t Time for which we want to calculate the values.
+	 *
+	 * @return ValueHolders containing the raw values of the members,
+	 *     in the order of \p members.
+	 */
+	std::vector<ValueHolder> get_values(std::span<const memberid_t> members, order_t t = LATEST_T) const;
+
 	/**
 	 * Get the calculated member value container for a given member at a given time.
 	 *
@@ -149,6 +179,130 @@ public:
 	 */
 	value_float_t get_float(const memberid_t &member, order_t t = LATEST_T) const;
 
+	/**
+	 * Get the calculated member value of a pre-resolved member at a given time.
+	 * Avoids looking up the member name on every call.
+	 *
+	 * @param member Member handle, see Database::member_handle().
+	 * @param t Time for which we want to calculate the value.
+	 *
+	 * @return ValueHolder containing the raw value of the member.
+	 */
+	ValueHolder get_value(const MemberHandle &member, order_t t = LATEST_T) const;
+
+	/**
+	 * Get the calculated member value container of a pre-resolved member at a given time.
+	 *
+	 * @tparam T nyan type of the value.
+	 *
+	 * @param member Member handle, see Database::member_handle().
+	 * @param t Time for which we want to calculate the value.
+	 *
+	 * @return Value of the member.
+	 */
+	template <ValueOrObjectLike T>
+	std::shared_ptr<T> get(const MemberHandle &member, order_t t = LATEST_T) const;
+
+	/**
+	 * Get the calculated member value container of a pre-resolved member at a given time.
+	 *
+	 * This variant of \p get() always explicitely tests if the member value
+	 * is \p None (i.e. if there is an optional value).
+	 *
+	 * @param member Member handle, see Database::member_handle().
+	 * @param t Time to retrieve the member for.
+	 *
+	 * @return Value of the member.
+	 */
+	template <ValueOrObjectLike T, bool may_be_none = true>
+	std::optional<std::shared_ptr<T>> get_optional(const MemberHandle &member, order_t t = LATEST_T) const;
+
+	/**
+	 * Get the calculated value of a pre-resolved number type member (\p int or \p float).
+	 *
+	 * @tparam Number type of the member.
+	 * @tparam Return type of the value.
+	 *
+	 * @param member Member handle, see Database::member_handle().
+	 * @param t Time for which we want to calculate the value.
+	 *
+	 * @return Value of the member.
+	 */
+	template <std::derived_from<NumberBase> T, typename ret = typename T::storage_type>
+	ret get_number(const MemberHandle &member, order_t t = LATEST_T) const;
+
+	/**
+	 * Get the calculated value of a pre-resolved \p int type member.
+	 *
+	 * @param member Member handle, see Database::member_handle().
+	 * @param t Time for which we want to calculate the value.
+	 *
+	 * @return Value of the member.
+	 */
+	value_int_t get_int(const MemberHandle &member, order_t t = LATEST_T) const;
+
+	/**
+	 * Get the calculated value of a pre-resolved \p float type member.
+	 *
+	 * @param member Member handle, see Database::member_handle().
+	 * @param t Time for which the value is calculated.
+	 *
+	 * @return Value of the member.
+	 */
+	value_float_t get_float(const MemberHandle &member, order_t t = LATEST_T) const;
+
+	/**
+	 * Get a value holder that contains the calculated member value
+	 * for a member that may not exist.
+	 *
+	 * Unlike get_value(), a missing member is not an error, so it can be
+	 * probed without the cost of an exception. The linearization is only
+	 * walked once.
+	 *
+	 * @param member Member ID.
+	 * @param t Time for which we want to calculate the value.
+	 *
+	 * @return ValueHolder containing the raw value of the member,
+	 *     or nothing if the object has no value for this member.
+	 */
+	std::optional<ValueHolder> try_get_value(const memberid_t &member, order_t t = LATEST_T) const;
+
+	/**
+	 * Get the calculated member value container for a member that may not exist.
+	 *
+	 * A \p None value is returned as nothing, too.
+	 * Throws a MemberTypeError if the member has a value of another type.
+	 *
+	 * @tparam T nyan type of the value.
+	 *
+	 * @param member Member ID.
+	 * @param t Time for which we want to calculate the value.
+	 *
+	 * @return Value of the member, or nothing if there is no value.
+	 */
+	template <ValueOrObjectLike T>
+	std::optional<std::shared_ptr<T>> try_get(const memberid_t &member, order_t t = LATEST_T) const;
+
+	/**
+	 * Get the calculated member value for an \p int type member that may not exist.
+	 *
+	 * @param member Member ID.
+	 * @param t Time for which we want to calculate the value.
+	 *
+	 * @return Value of the member, or nothing if there is no value.
+	 */
+	std::optional<value_int_t> try_get_int(const memberid_t &member, order_t t = LATEST_T) const;
+
+	/**
+	 * Get the calculated member value for a \p float type member that may not exist.
+	 *
+	 * @param member Member ID.
+	 * @param t Time for which we want to calculate the value.
+	 *
+	 * @return Value of the member, or nothing if there is no value.
+	 */
+	std::optional<value_float_t> try_get_float(const memberid_t &member, order_t t = LATEST_T) const;
+
 	/**
 	 * Get the calculated member value for an \p text type member.
 	 *
@@ -288,7 +442,8 @@ public:
 	 *
 	 * @param t Time for which the C3 linearization is calculated.
 	 *
-	 * @return C3 linearization of this object.
+	 * @return C3 linearization of this object. The reference is valid
+	 *     until the next transaction is committed in the view.
 	 */
 	const std::vector<fqon_t> &get_linearized(order_t t = LATEST_T) const;
 
@@ -316,14 +471,97 @@ protected:
 	const std::shared_ptr<ObjectState> &get_raw(order_t t = LATEST_T) const;
 
 	/**
-	 * Get the calculated member value for a given member at a given time.
+	 * Get the precomputed inheritance facts of this object.
+	 *
+	 * @param t Point in time for which the lineage is retrieved.
+	 *
+	 * @return Lineage of the object at time \p t.
+	 */
+	const Lineage &get_lineage(order_t t = LATEST_T) const;
+
+	/**
+	 * Get the interned symbol of a member identifier.
 	 *
 	 * @param member Identifier of the member.
+	 *
+	 * @return Pointer to the member symbol if any object has a member
+	 *     with that identifier, else nullptr.
+	 */
+	const symbol_t *find_member_symbol(const memberid_t &member) const;
+
+	/**
+	 * Get the member value from the value cache, or calculate
+	 * and cache it if it's not in there.
+	 *
+	 * @param member Symbol of the member identifier.
+	 * @param t Time for which we want the value.
+	 *
+	 * @return ValueHolder with a copy of the value of the member.
+	 */
+	ValueHolder get_member_value(symbol_t member, order_t t) const;
+
+	/**
+	 * Get the member value from the value cache, or calculate
+	 * and cache it if it's not in there.
+	 *
+	 * @param member Symbol of the member identifier.
+	 * @param t Time for which we want the value.
+	 *
+	 * @return ValueHolder with a copy of the value of the member,
+	 *     or nothing if no parent assigns a value.
+	 */
+	std::optional<ValueHolder> try_get_member_value(symbol_t member, order_t t) const;
+
+	/**
+	 * Cast a member value to the requested nyan type.
+	 *
+	 * @param value Value of the member.
+	 * @param member Identifier of the member, for error messages.
+	 *
+	 * @return Value of the member, or nothing if the value is \p None
+	 *     and \p may_be_none is set.
+	 */
+	template <ValueOrObjectLike T, bool may_be_none>
+	std::optional<std::shared_ptr<T>> cast_value(const ValueHolder &value, const memberid_t &member) const;
+
+	/**
+	 * Get the calculated member value for a given member at a given time.
+	 *
+	 * @param member Symbol of the member identifier.
 	 * @param t Time for which we want to calculate the value.
 	 *
 	 * @return ValueHolder with the value of the member.
 	 */
-	ValueHolder calculate_value(const memberid_t &member, order_t t = LATEST_T) const;
+	ValueHolder calculate_value(symbol_t member, order_t t = LATEST_T) const;
+
+	/**
+	 * Get the calculated member value for a given member at a given time.
+	 *
+	 * @param member Symbol of the member identifier.
+	 * @param t Time for which we want to calculate the value.
+	 *
+	 * @return ValueHolder with the value of the member,
+	 *     or nothing if no parent assigns a value.
+	 */
+	std::optional<ValueHolder> try_calculate_value(symbol_t member, order_t t = LATEST_T) const;
+
+	/**
+	 * Get the calculated member value for a given member at a given time,
+	 * reusing the parent states of previous calculations.
+	 *
+	 * @param member Symbol of the member identifier.
+	 * @param linearization Linearization of this object at time \p t.
+	 * @param parents States of the objects in the linearization at time \p t,
+	 *     as far as they were needed so far. Missing states are appended.
+	 * @param t Time for which we want to calculate the value.
+	 *
+	 * @return ValueHolder with the value of the member,
+	 *     or nothing if no parent assigns a value.
+	 */
+	std::optional<ValueHolder> try_calculate_value(symbol_t member,
+	                                               const std::vector<fqon_t> &linearization,
+	                                               std::vector<std::shared_ptr<ObjectState>> *parents,
+	                                               order_t t) const;
 
 	/**
 	 * View the object was created from.
@@ -334,6 +572,11 @@ protected:
 	 * Identifier of the object.
 	 */
 	fqon_t name;
+
+	/**
+	 * Interned identifier of the object, used for the lookups in the view.
+	 */
+	symbol_t symbol = 0;
 };
 
 
@@ -344,9 +587,28 @@ std::shared_ptr<T> Object::get(const memberid_t &member, order_t t) const {
 }
 
 
+template <ValueOrObjectLike T>
+std::shared_ptr<T> Object::get(const MemberHandle &member, order_t t) const {
+	auto ret = this->get_optional<T, false>(member, t);
+	return *ret;
+}
+
+
 template <ValueOrObjectLike T, bool may_be_none>
 std::optional<std::shared_ptr<T>> Object::get_optional(const memberid_t &member, order_t t) const {
-	std::shared_ptr<Value> value = this->get_value(member, t).get_ptr();
+	return this->cast_value<T, may_be_none>(this->get_value(member, t), member);
+}
+
+
+template <ValueOrObjectLike T, bool may_be_none>
+std::optional<std::shared_ptr<T>> Object::get_optional(const MemberHandle &member, order_t t) const {
+	return this->cast_value<T, may_be_none>(this->get_value(member, t), member.get_name());
+}
+
+
+template <ValueOrObjectLike T, bool may_be_none>
+std::optional<std::shared_ptr<T>> Object::cast_value(const ValueHolder &holder, const memberid_t &member) const {
+	const std::shared_ptr<Value> &value = holder.get_ptr();
 	if constexpr (may_be_none) {
 		if (value == None::value) {
 			return {};
@@ -367,12 +629,29 @@ std::optional<std::shared_ptr<T>> Object::get_optional(const memberid_t &member,
 }
 
 
+template <ValueOrObjectLike T>
+std::optional<std::shared_ptr<T>> Object::try_get(const memberid_t &member, order_t t) const {
+	auto value = this->try_get_value(member, t);
+	if (not value.has_value()) {
+		return {};
+	}
+
+	return this->cast_value<T, true>(*value, member);
+}
+
+
 template <std::derived_from<NumberBase> T, typename ret>
 ret Object::get_number(const memberid_t &member, order_t t) const {
 	return *this->get<T>(member, t);
 }
 
 
+template <std::derived_from<NumberBase> T, typename ret>
+ret Object::get_number(const MemberHandle &member, order_t t) const {
+	return *this->get<T>(member, t);
+}
+
+
 /**
  * Specialization of the get function to generate a nyan::Object
  * from the ObjectValue that is stored in a value.
@@ -381,6 +660,14 @@ template <>
 std::shared_ptr<Object> Object::get<Object>(const memberid_t &member, order_t t) const;
 
 
+/**
+ * Specialization of the get function to generate a nyan::Object
+ * from the ObjectValue that is stored in a pre-resolved member.
+ */
+template <>
+std::shared_ptr<Object> Object::get<Object>(const MemberHandle &member, order_t t) const;
+
+
 /**
  * Specialization of the get_optional function to generate a nyan::Object
  * from the ObjectValue that is stored in a optional value.
@@ -391,4 +678,20 @@ std::shared_ptr<Object> Object::get<Object>(const memberid_t &member, order_t t)
 template <>
 std::optional<std::shared_ptr<Object>> Object::get_optional<Object>(const memberid_t &member, order_t t) const;
 
+
+/**
+ * Specialization of the get_optional function to generate a nyan::Object
+ * from the ObjectValue that is stored in a pre-resolved optional member.
+ */
+template <>
+std::optional<std::shared_ptr<Object>> Object::get_optional<Object>(const MemberHandle &member, order_t t) const;
+
+
+/**
+ * Specialization of the try_get function to generate a nyan::Object
+ * from the ObjectValue that is stored in a member that may not exist.
+ */
+template <>
+std::optional<std::shared_ptr<Object>> Object::try_get<Object>(const memberid_t &member, order_t t) const;
+
 } // namespace nyan
@@ -7,6 +7,46 @@
 
 namespace nyan {
 
+namespace {
+
+/**
+ * Check if a cache entry is still valid at a given time.
+ *
+ * @param invalidations Points in time where the cache was invalidated.
+ * @param calculated Time the entry was calculated for.
+ * @param t Time the entry is requested for.
+ *
+ * @return true if there was no invalidation after the calculation, else false.
+ */
+bool cache_valid(const std::set<order_t> &invalidations, order_t calculated, order_t t) {
+	// the entry is outdated if the object changed after
+	// it was calculated, but before the requested time.
+	auto inv = invalidations.upper_bound(t);
+	if (inv != std::begin(invalidations)) {
+		--inv;
+		if (*inv > calculated) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+/**
+ * Record a cache invalidation.
+ *
+ * @param invalidations Points in time where the cache was invalidated.
+ * @param t Time of the invalidation.
+ */
+void add_invalidation(std::set<order_t> &invalidations, order_t t) {
+	// later invalidations belong to the history that is replaced now
+	auto it = invalidations.lower_bound(t);
+	invalidations.erase(it, std::end(invalidations));
+	invalidations.insert(t);
+}
+
+} // namespace
+
 
 void ObjectHistory::insert_change(const order_t time) {
 	auto it = this->changes.lower_bound(time);
@@ -35,4 +75,84 @@ std::optional<order_t> ObjectHistory::last_change_before(order_t t) const {
 	return *it;
 }
 
+
+void ObjectHistory::drop_after(order_t t) {
+	if (t == LATEST_T) {
+		// nothing can be later.
+		return;
+	}
+
+	auto it = this->changes.upper_bound(t);
+	this->changes.erase(it, std::end(this->changes));
+
+	this->linearizations.drop(t + 1);
+	this->lineages.drop(t + 1);
+	this->children.drop(t + 1);
+
+	// descendants cached until t were calculated from children that stay.
+	this->descendants.drop(t + 1);
+	auto inv = this->descendant_invalidations.upper_bound(t);
+	this->descendant_invalidations.erase(inv, std::end(this->descendant_invalidations));
+}
+
+
+const ValueHolder *ObjectHistory::get_value(symbol_t member, order_t t) const {
+	auto it = this->values.find(member);
+	if (it == std::end(this->values)) {
+		return nullptr;
+	}
+
+	const auto *keyframe = it->second.keyframe_at(t);
+	if (keyframe == nullptr) {
+		return nullptr;
+	}
+
+	if (not cache_valid(this->value_invalidations, keyframe->first, t)) {
+		return nullptr;
+	}
+
+	return &keyframe->second;
+}
+
+
+void ObjectHistory::insert_value(symbol_t member, order_t t, const ValueHolder &value) {
+	this->values[member].insert(t, ValueHolder{value});
+}
+
+
+void ObjectHistory::invalidate_values(order_t t) {
+	// values calculated at or after the invalidation are outdated
+	for (auto &it : this->values) {
+		it.second.drop(t);
+	}
+
+	add_invalidation(this->value_invalidations, t);
+}
+
+
+const std::unordered_set<fqon_t> *ObjectHistory::get_descendants(order_t t) const {
+	const auto *keyframe = this->descendants.keyframe_at(t);
+	if (keyframe == nullptr) {
+		return nullptr;
+	}
+
+	if (not cache_valid(this->descendant_invalidations, keyframe->first, t)) {
+		return nullptr;
+	}
+
+	return &keyframe->second;
+}
+
+
+const std::unordered_set<fqon_t> &ObjectHistory::insert_descendants(order_t t,
+                                                                  std::unordered_set<fqon_t> &&ins) {
+	return this->descendants.insert(t, std::move(ins));
+}
+
+
+void ObjectHistory::invalidate_descendants(order_t t) {
+	this->descendants.drop(t);
+	add_invalidation(this->descendant_invalidations, t);
+}
+
 } // namespace nyan
@@ -3,12 +3,15 @@
 
 #include <optional>
 #include <set>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "config.h"
 #include "curve.h"
+#include "lineage.h"
+#include "value/value_holder.h"
 
 
 namespace nyan {
@@ -38,13 +41,83 @@ public:
 	 */
 	std::optional<order_t> last_change_before(order_t t) const;
 
-	// TODO: curve for value cache: memberid_t => curve<valueholder>
+	/**
+	 * Remove all change records, linearizations, children and descendants
+	 * that are later than the given time.
+	 * Used when the history after that time is replaced.
+	 *
+	 * @param t Time after which the records are removed.
+	 */
+	void drop_after(order_t t);
+
+	/**
+	 * Get a previously calculated value of a member.
+	 *
+	 * @param member Symbol of the member identifier.
+	 * @param t Time for which the value is requested.
+	 *
+	 * @return Pointer to the cached value if it is still valid at time \p t, else nullptr.
+	 */
+	const ValueHolder *get_value(symbol_t member, order_t t) const;
+
+	/**
+	 * Store a calculated value of a member in the value cache.
+	 * The value stays valid until the next invalidation of this object.
+	 *
+	 * @param member Symbol of the member identifier.
+	 * @param t Time for which the value was calculated.
+	 * @param value Calculated value of the member.
+	 */
+	void insert_value(symbol_t member, order_t t, const ValueHolder &value);
+
+	/**
+	 * Invalidate all cached values of this object from a given time on.
+	 * Must be called whenever this object or one of its parents changes.
+	 *
+	 * @param t Time from which on the cached values are no longer valid.
+	 */
+	void invalidate_values(order_t t);
+
+	/**
+	 * Get the previously gathered transitive children of this object.
+	 *
+	 * @param t Time for which the descendants are requested.
+	 *
+	 * @return Pointer to the cached descendants if they are still valid at
+	 *     time \p t, else nullptr.
+	 */
+	const std::unordered_set<fqon_t> *get_descendants(order_t t) const;
+
+	/**
+	 * Store the gathered transitive children of this object.
+	 *
+	 * @param t Time for which the descendants were gathered.
+	 * @param ins All transitive children of this object.
+	 *
+	 * @return The stored descendants.
+	 */
+	const std::unordered_set<fqon_t> &insert_descendants(order_t t, std::unordered_set<fqon_t> &&ins);
+
+	/**
+	 * Invalidate the cached descendants from a given time on.
+	 * Must be called whenever the children of this object
+	 * or one of its descendants change.
+	 *
+	 * @param t Time from which on the cached descendants are no longer valid.
+	 */
+	void invalidate_descendants(order_t t);
 
 	/**
 	 * Stores the parent linearization of this object over time.
 	 */
 	Curve<std::vector<fqon_t>> linearizations;
 
+	/**
+	 * Stores the lineage of this object over time.
+	 * Has a keyframe for each keyframe in the linearizations.
+	 */
+	Curve<Lineage> lineages;
+
 	/**
 	 * Stores the direct children an object has over time.
 	 */
@@ -57,6 +130,31 @@ protected:
 	 * object state in the state history.
 	 */
 	std::set<order_t> changes;
+
+	/**
+	 * Calculated member values over time.
+	 * A value cached at some time is valid until the next invalidation.
+	 */
+	std::unordered_map<symbol_t, Curve<ValueHolder>> values;
+
+	/**
+	 * Points in time where the cached values were invalidated,
+	 * i.e. where this object or one of its parents changed.
+	 */
+	std::set<order_t> value_invalidations;
+
+	/**
+	 * Transitive children of the object over time.
+	 * Gathered on request, valid until the next invalidation.
+	 * Map storage so handed out references survive later insertions.
+	 */
+	Curve<std::unordered_set<fqon_t>, curve_storage::MAP> descendants;
+
+	/**
+	 * Points in time where the cached descendants were invalidated,
+	 * i.e. where the children of this object or one of its descendants changed.
+	 */
+	std::set<order_t> descendant_invalidations;
 };
 
 
@@ -4,6 +4,8 @@
 
 #include <sstream>
 
+#include "compiler.h"
+#include "error.h"
 #include "lang_error.h"
 #include "patch_info.h"
 #include "state.h"
@@ -19,6 +21,14 @@ ObjectInfo::ObjectInfo(const Location &location,
 	initial_patch{false} {}
 
 
+const fqon_t &ObjectInfo::get_name() const {
+	if (unlikely(this->name == nullptr)) {
+		throw InternalError{"object information has no name yet"};
+	}
+	return *this->name;
+}
+
+
 const Location &ObjectInfo::get_location() const {
 	return this->location;
 }
@@ -107,6 +117,16 @@ const std::vector<fqon_t> &ObjectInfo::get_linearization() const {
 }
 
 
+void ObjectInfo::set_lineage(Lineage &&lineage) {
+	this->initial_lineage = std::move(lineage);
+}
+
+
+const Lineage &ObjectInfo::get_lineage() const {
+	return this->initial_lineage;
+}
+
+
 void ObjectInfo::add_children(std::unordered_set<fqon_t> &&children) {
 	this->initial_children.insert(children.begin(), children.end());
 }
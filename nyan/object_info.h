@@ -7,6 +7,7 @@
 
 #include "config.h"
 #include "inheritance_change.h"
+#include "lineage.h"
 #include "location.h"
 #include "member_info.h"
 #include "namespace.h"
@@ -15,6 +16,7 @@
 
 namespace nyan {
 
+class MetaInfo;
 class PatchInfo;
 class State;
 
@@ -31,6 +33,14 @@ public:
 	                    const Namespace &ns);
 	~ObjectInfo() = default;
 
+	/**
+	 * Get the identifier of this object.
+	 * Only available once the object was added to the MetaInfo.
+	 *
+	 * @return fqon of the object.
+	 */
+	const fqon_t &get_name() const;
+
 	/**
 	 * Get the position of this object in a file.
 	 *
@@ -128,6 +138,20 @@ public:
 	 */
 	const std::vector<fqon_t> &get_linearization() const;
 
+	/**
+	 * Set the lineage of the object at load time.
+	 *
+	 * @param lineage Inheritance facts derived from the initial linearization.
+	 */
+	void set_lineage(Lineage &&lineage);
+
+	/**
+	 * Get the lineage of the object at load time.
+	 *
+	 * @return Inheritance facts derived from the initial linearization.
+	 */
+	const Lineage &get_lineage() const;
+
 	/**
 	 * Add children to the object.
 	 *
@@ -172,6 +196,14 @@ public:
 	std::string str() const;
 
 protected:
+	// sets the name when the object is added.
+	friend class MetaInfo;
+
+	/**
+	 * Identifier of the object, stored in the object symbol table.
+	 */
+	const fqon_t *name = nullptr;
+
 	/**
 	 * Location where the object was defined.
 	 */
@@ -209,6 +241,11 @@ protected:
 	 */
 	std::vector<fqon_t> initial_linearization;
 
+	/**
+	 * Lineage of the object at load time.
+	 */
+	Lineage initial_lineage;
+
 	/**
 	 * Direct children of the object at load time.
 	 */
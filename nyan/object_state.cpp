@@ -7,6 +7,7 @@
 
 #include "change_tracker.h"
 #include "compiler.h"
+#include "meta_info.h"
 #include "object_info.h"
 #include "util.h"
 
@@ -50,7 +51,7 @@ void ObjectState::apply(const std::shared_ptr<ObjectState> &mod,
 	}
 
 	// change each member in this object by the member of the patch.
-	// other->members: maps memberid_t name => Member
+	// other->members: maps member symbol => Member
 	for (auto &it : mod->members) {
 		auto search = this->members.find(it.first);
 		if (search == std::end(this->members)) {
@@ -86,12 +87,12 @@ const std::deque<fqon_t> &ObjectState::get_parents() const {
 }
 
 
-bool ObjectState::has(const memberid_t &name) const {
+bool ObjectState::has(symbol_t name) const {
 	return this->members.find(name) != std::end(this->members);
 }
 
 
-Member *ObjectState::get(const memberid_t &name) {
+Member *ObjectState::get(symbol_t name) {
 	auto it = this->members.find(name);
 	if (it == std::end(this->members)) {
 		return nullptr;
@@ -101,7 +102,7 @@ Member *ObjectState::get(const memberid_t &name) {
 
 
 // Thanks C++, always redundancy free!
-const Member *ObjectState::get(const memberid_t &name) const {
+const Member *ObjectState::get(symbol_t name) const {
 	auto it = this->members.find(name);
 	if (it == std::end(this->members)) {
 		return nullptr;
@@ -110,12 +111,12 @@ const Member *ObjectState::get(const memberid_t &name) const {
 }
 
 
-const std::unordered_map<memberid_t, Member> &ObjectState::get_members() const {
+const std::unordered_map<symbol_t, Member> &ObjectState::get_members() const {
 	return this->members;
 }
 
 
-std::string ObjectState::str() const {
+std::string ObjectState::str(const MetaInfo &meta_info) const {
 	std::ostringstream builder;
 
 	builder << "ObjectState("
@@ -128,7 +129,7 @@ std::string ObjectState::str() const {
 	}
 
 	for (auto &it : this->members) {
-		builder << "    " << it.first
+		builder << "    " << meta_info.get_member_symbols().get_name(it.first)
 				<< " -> " << it.second.str() << std::endl;
 	}
 
@@ -136,7 +137,7 @@ std::string ObjectState::str() const {
 }
 
 
-void ObjectState::set_members(std::unordered_map<memberid_t, Member> &&members) {
+void ObjectState::set_members(std::unordered_map<symbol_t, Member> &&members) {
 	this->members = std::move(members);
 }
 
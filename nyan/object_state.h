@@ -4,12 +4,15 @@
 #include <deque>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
+#include "config.h"
 #include "member.h"
 
 
 namespace nyan {
 
+class MetaInfo;
 class ObjectChanges;
 class ObjectInfo;
 
@@ -19,6 +22,7 @@ class ObjectInfo;
  */
 class ObjectState {
 	friend class Database;
+	friend class Snapshot;
 
 public:
 	/**
@@ -54,51 +58,54 @@ public:
 	/**
 	 * Check if the object has a member with a given identifier.
 	 *
-	 * @param name Identifier of the member.
+	 * @param name Symbol of the member identifier.
 	 *
 	 * @return true if the object has a member with the identifier, else false.
 	 */
-	bool has(const memberid_t &name) const;
+	bool has(symbol_t name) const;
 
 	/**
 	 * Get the pointer to a member with a given identifier.
 	 *
-	 * @param name Identifier of the member.
+	 * @param name Symbol of the member identifier.
 	 *
 	 * @return Pointer to the member if the object has this member, else nullptr.
 	 */
-	Member *get(const memberid_t &name);
+	Member *get(symbol_t name);
 
 	/**
 	 * Get the pointer to a member with a given identifier.
 	 *
-	 * @param name Identifier of the member.
+	 * @param name Symbol of the member identifier.
 	 *
 	 * @return Pointer to the member object if the object has this member, else nullptr.
 	 */
-	const Member *get(const memberid_t &name) const;
+	const Member *get(symbol_t name) const;
 
 	/**
 	 * Get the members of this object.
 	 *
-	 * @return Map of the member objects by member identifer.
+	 * @return Map of the member objects by member symbol.
 	 */
-	const std::unordered_map<memberid_t, Member> &get_members() const;
+	const std::unordered_map<symbol_t, Member> &get_members() const;
 
 	/**
 	 * Get the string representation of this object state.
 	 *
+	 * @param meta_info Metadata information of the database,
+	 *     used to print the member names.
+	 *
 	 * @return String representation of this object state.
 	 */
-	std::string str() const;
+	std::string str(const MetaInfo &meta_info) const;
 
 private:
 	/**
 	 * Replace the member map. Used for creating initial object states.
 	 *
-	 * @param members Map of the member objects by member identifer.
+	 * @param members Map of the member objects by member symbol.
 	 */
-	void set_members(std::unordered_map<memberid_t, Member> &&members);
+	void set_members(std::unordered_map<symbol_t, Member> &&members);
 
 	/**
 	 * Parent objects.
@@ -107,8 +114,9 @@ private:
 
 	/**
 	 * Member objects storage.
+	 * Keyed by the member symbols of the database MetaInfo.
 	 */
-	std::unordered_map<memberid_t, Member> members;
+	std::unordered_map<symbol_t, Member> members;
 
 	// The object location is stored in the metainfo-database.
 };
@@ -39,7 +39,7 @@ nyan_op op_from_string(const std::string &str) {
 
 nyan_op op_from_token(const Token &token) {
 	if (token.type == token_type::OPERATOR) {
-		return op_from_string(token.get());
+		return op_from_string(std::string{token.get()});
 	}
 	else {
 		throw ASTError("expected operator, but got", token);
@@ -2,6 +2,10 @@
 
 #include "parser.h"
 
+#include <algorithm>
+#include <memory>
+#include <memory_resource>
+
 #include "ast.h"
 #include "compiler.h"
 #include "database.h"
@@ -21,6 +25,26 @@
 
 namespace nyan {
 
+namespace {
+
+/**
+ * Create the arena for the AST nodes of a file.
+ * The buffer grows with the file, but can't be empty:
+ * the initial size of a monotonic_buffer_resource must be positive.
+ *
+ * @param file File the AST is created for.
+ *
+ * @return The new arena.
+ */
+std::unique_ptr<std::pmr::monotonic_buffer_resource> make_arena(const File &file) {
+	constexpr size_t min_size = 1024;
+	return std::make_unique<std::pmr::monotonic_buffer_resource>(
+		std::max<size_t>(file.size(), min_size));
+}
+
+} // namespace
+
+
 Parser::Parser() = default;
 
 
@@ -28,13 +52,15 @@ AST Parser::parse(const std::shared_ptr<File> &file) {
 	// If you are some parser junkie and I trigger your rage mode now,
 	// feel free to rewrite the parser or use a tool like bison.
 
-	// tokenize input
-	std::vector<Token> tokens = this->tokenize(file);
+	// the tokens are generated while the ast is created,
+	// so the whole token list is never in memory.
+	// the AST nodes are freed together, so they don't need individual allocations.
+	auto arena = make_arena(*file);
 
-	// create ast from tokens
-	AST ast = this->create_ast(tokens);
+	Lexer lexer{file};
+	TokenStream tokens{lexer, arena.get()};
 
-	return ast;
+	return AST{file, std::move(arena), tokens};
 }
 
 
@@ -58,10 +84,11 @@ std::vector<Token> Parser::tokenize(const std::shared_ptr<File> &file) const {
 }
 
 
-AST Parser::create_ast(const std::vector<Token> &tokens) const {
-	TokenStream token_iter{tokens};
-	AST root{token_iter};
-	return root;
+AST Parser::create_ast(const std::shared_ptr<File> &file,
+                       const std::vector<Token> &tokens) const {
+	auto arena = make_arena(*file);
+	TokenStream token_iter{tokens, arena.get()};
+	return AST{file, std::move(arena), token_iter};
 }
 
 } // namespace nyan
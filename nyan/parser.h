@@ -25,6 +25,7 @@ public:
 
 	/**
 	 * Parse a nyan file and return its AST (abstact syntax tree).
+	 * The tokens are streamed from the lexer into the AST creation.
 	 *
 	 * @param file Shared pointer to a nyan data file.
 	 *
@@ -45,11 +46,13 @@ protected:
 	/**
 	 * Create an AST (abstact syntax tree) from a token list.
 	 *
+	 * @param file File the tokens were read from.
 	 * @param tokens List of tokens.
 	 *
 	 * @return AST of the token list.
 	 */
-	AST create_ast(const std::vector<Token> &tokens) const;
+	AST create_ast(const std::shared_ptr<File> &file,
+	               const std::vector<Token> &tokens) const;
 
 #if 0
 	/**
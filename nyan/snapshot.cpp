@@ -0,0 +1,711 @@
+// Copyright 2026-2026 the nyan authors, LGPLv3+. See copying.md for legal info.
+
+#include "snapshot.h"
+
+#include <algorithm>
+#include <bit>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "compiler.h"
+#include "database.h"
+#include "error.h"
+#include "file.h"
+#include "inheritance_change.h"
+#include "lineage.h"
+#include "location.h"
+#include "member.h"
+#include "member_info.h"
+#include "meta_info.h"
+#include "namespace.h"
+#include "object_info.h"
+#include "object_state.h"
+#include "patch_info.h"
+#include "state.h"
+#include "type.h"
+#include "util.h"
+#include "value/boolean.h"
+#include "value/dict.h"
+#include "value/file.h"
+#include "value/none.h"
+#include "value/number.h"
+#include "value/object.h"
+#include "value/orderedset.h"
+#include "value/set.h"
+#include "value/text.h"
+
+
+namespace nyan {
+
+namespace {
+
+/**
+ * Stored kind of a value, selects the Value subclass.
+ */
+enum class value_tag : uint8_t {
+	NONE,
+	BOOLEAN,
+	TEXT,
+	FILENAME,
+	INT,
+	FLOAT,
+	OBJECT,
+	SET,
+	ORDEREDSET,
+	DICT,
+};
+
+
+/**
+ * Encodes primitives in little endian, independent of the host.
+ * Objects that are shared between several owners (files, types, patches)
+ * are stored once and referenced by index afterwards.
+ */
+class SnapshotWriter {
+public:
+	explicit SnapshotWriter(std::ostream &out) :
+		out{out} {}
+
+	void u8(uint8_t value) {
+		this->out.put(static_cast<char>(value));
+	}
+
+	void u32(uint32_t value) {
+		for (int i = 0; i < 4; i++) {
+			this->u8(static_cast<uint8_t>(value >> (i * 8)));
+		}
+	}
+
+	void u64(uint64_t value) {
+		for (int i = 0; i < 8; i++) {
+			this->u8(static_cast<uint8_t>(value >> (i * 8)));
+		}
+	}
+
+	void size(size_t value) {
+		this->u64(value);
+	}
+
+	void str(std::string_view value) {
+		this->size(value.size());
+		this->out.write(value.data(), static_cast<std::streamsize>(value.size()));
+	}
+
+	void strs(const auto &values) {
+		this->size(values.size());
+		for (auto &value : values) {
+			this->str(value);
+		}
+	}
+
+	/**
+	 * Write a reference to a shared object.
+	 * Index 0 is nullptr, the object content follows on its first use.
+	 *
+	 * @return true if the content has to be written now.
+	 */
+	bool shared(const void *ptr) {
+		if (ptr == nullptr) {
+			this->u32(0);
+			return false;
+		}
+
+		auto ins = this->shared_ids.emplace(ptr, this->shared_ids.size() + 1);
+		this->u32(ins.first->second);
+		return ins.second;
+	}
+
+	void location(const Location &loc) {
+		this->u8(loc.is_builtin());
+		if (loc.is_builtin()) {
+			this->str(loc.get_msg());
+			return;
+		}
+
+		const File *file = loc.get_file().get();
+		if (this->shared(file)) {
+			this->str(file->get_name());
+			if (file->is_released()) {
+				// keep the lines for error messages of the restored database.
+				std::string content;
+				try {
+					content = util::read_file(file->get_name());
+				}
+				catch (FileReadError &) {}
+				this->str(content);
+			}
+			else {
+				this->str(file->get_content());
+			}
+		}
+		this->u32(static_cast<uint32_t>(loc.get_line()));
+		this->u32(static_cast<uint32_t>(loc.get_line_offset()));
+		this->u32(static_cast<uint32_t>(loc.get_length()));
+	}
+
+	void ns(const Namespace &ns) {
+		this->strs(ns.get_dir_components());
+		this->str(ns.get_filename());
+		this->strs(ns.get_obj_components());
+	}
+
+	void flush() {
+		this->out.flush();
+		if (unlikely(not this->out)) {
+			throw SnapshotError{"failed to write database snapshot"};
+		}
+	}
+
+protected:
+	std::ostream &out;
+
+	/**
+	 * Index of each shared object that was written already.
+	 */
+	std::unordered_map<const void *, uint32_t> shared_ids;
+};
+
+
+/**
+ * Decodes what the SnapshotWriter wrote.
+ */
+class SnapshotReader {
+public:
+	explicit SnapshotReader(std::istream &in) :
+		in{in} {}
+
+	uint8_t u8() {
+		int value = this->in.get();
+		if (unlikely(value == std::istream::traits_type::eof())) {
+			throw SnapshotError{"database snapshot is truncated"};
+		}
+		return static_cast<uint8_t>(value);
+	}
+
+	uint32_t u32() {
+		uint32_t value = 0;
+		for (int i = 0; i < 4; i++) {
+			value |= static_cast<uint32_t>(this->u8()) << (i * 8);
+		}
+		return value;
+	}
+
+	uint64_t u64() {
+		uint64_t value = 0;
+		for (int i = 0; i < 8; i++) {
+			value |= static_cast<uint64_t>(this->u8()) << (i * 8);
+		}
+		return value;
+	}
+
+	size_t size() {
+		return static_cast<size_t>(this->u64());
+	}
+
+	std::string str() {
+		size_t len = this->size();
+		std::string value;
+
+		// read in blocks, so a corrupted length can't allocate everything.
+		constexpr size_t block_size = 1 << 16;
+		while (value.size() < len) {
+			size_t pos = value.size();
+			size_t count = std::min(block_size, len - pos);
+			value.resize(pos + count);
+			this->in.read(value.data() + pos, static_cast<std::streamsize>(count));
+			if (unlikely(not this->in)) {
+				throw SnapshotError{"database snapshot is truncated"};
+			}
+		}
+		return value;
+	}
+
+	std::vector<std::string> strs() {
+		size_t count = this->size();
+		std::vector<std::string> values;
+		for (size_t i = 0; i < count; i++) {
+			values.push_back(this->str());
+		}
+		return values;
+	}
+
+	/**
+	 * Read a reference to a shared object, see SnapshotWriter::shared.
+	 * Calls the reader for the content on the first use.
+	 */
+	template <typename T, typename F>
+	std::shared_ptr<T> shared(std::vector<std::shared_ptr<T>> &known, const F &read_content) {
+		uint32_t id = this->u32();
+		if (id == 0) {
+			return nullptr;
+		}
+
+		if (id == this->shared_count + 1) {
+			this->shared_count += 1;
+			if (known.size() < this->shared_count + 1) {
+				known.resize(this->shared_count + 1);
+			}
+			known[id] = read_content();
+			return known[id];
+		}
+
+		if (unlikely(id > this->shared_count or id >= known.size() or known[id] == nullptr)) {
+			throw SnapshotError{"database snapshot references an unknown entry"};
+		}
+		return known[id];
+	}
+
+	Location location() {
+		if (this->u8()) {
+			return Location{this->str()};
+		}
+
+		std::shared_ptr<File> file = this->shared(this->files, [this]() {
+			std::string name = this->str();
+			return std::make_shared<File>(name, this->str());
+		});
+		if (unlikely(file == nullptr)) {
+			throw SnapshotError{"database snapshot has a location without file"};
+		}
+
+		int line = static_cast<int>(this->u32());
+		int line_offset = static_cast<int>(this->u32());
+		int length = static_cast<int>(this->u32());
+		return Location{file, line, line_offset, length};
+	}
+
+	Namespace ns() {
+		std::vector<std::string> dir_components = this->strs();
+		std::string filename = this->str();
+		return Namespace{std::move(dir_components), std::move(filename), this->strs()};
+	}
+
+	std::vector<std::shared_ptr<File>> files;
+	std::vector<std::shared_ptr<Type>> types;
+	std::vector<std::shared_ptr<PatchInfo>> patches;
+
+protected:
+	std::istream &in;
+
+	/**
+	 * Number of shared objects read so far, over all kinds.
+	 */
+	uint32_t shared_count = 0;
+};
+
+
+/**
+ * Sort the keys of a hash container, so the snapshot doesn't
+ * depend on the iteration order of the container.
+ */
+template <typename C>
+auto sorted_keys(const C &container) {
+	std::vector<typename C::key_type> keys;
+	keys.reserve(container.size());
+	for (auto &it : container) {
+		if constexpr (requires { it.first; }) {
+			keys.push_back(it.first);
+		}
+		else {
+			keys.push_back(it);
+		}
+	}
+	std::sort(std::begin(keys), std::end(keys));
+	return keys;
+}
+
+
+void write_value(SnapshotWriter &writer, const Value &value);
+ValueHolder read_value(SnapshotReader &reader);
+
+} // namespace
+
+
+template <typename W>
+void Snapshot::write_type(W &writer, const Type &type) {
+	const BasicType &basic_type = type.get_basic_type();
+	writer.u8(static_cast<uint8_t>(basic_type.primitive_type));
+	writer.u8(static_cast<uint8_t>(basic_type.composite_type));
+
+	uint8_t modifiers = 0;
+	for (size_t i = 0; i < static_cast<size_t>(modifier_t::size); i++) {
+		if (type.has_modifier(static_cast<modifier_t>(i))) {
+			modifiers |= 1 << i;
+		}
+	}
+	writer.u8(modifiers);
+
+	writer.str(type.is_object() ? type.get_fqon() : "");
+
+	writer.u8(type.element_type.has_value());
+	if (type.element_type.has_value()) {
+		const auto &element_types = *type.element_type;
+		writer.size(element_types.size());
+		for (auto &element_type : element_types) {
+			Snapshot::write_type(writer, element_type);
+		}
+	}
+}
+
+
+template <typename R>
+Type Snapshot::read_type(R &reader) {
+	Type type;
+	type.basic_type.primitive_type = static_cast<primitive_t>(reader.u8());
+	type.basic_type.composite_type = static_cast<composite_t>(reader.u8());
+
+	uint8_t modifiers = reader.u8();
+	for (size_t i = 0; i < static_cast<size_t>(modifier_t::size); i++) {
+		if (modifiers & (1 << i)) {
+			type.modifiers.set(static_cast<modifier_t>(i));
+		}
+	}
+
+	type.obj_ref = reader.str();
+
+	if (reader.u8()) {
+		std::vector<Type> element_types;
+		size_t count = reader.size();
+		for (size_t i = 0; i < count; i++) {
+			element_types.push_back(Snapshot::read_type(reader));
+		}
+		type.element_type = std::move(element_types);
+	}
+
+	return type;
+}
+
+
+void Snapshot::write(const Database &database, std::ostream &out) {
+	SnapshotWriter writer{out};
+	const MetaInfo &meta_info = database.meta_info;
+
+	for (char c : Snapshot::magic) {
+		writer.u8(static_cast<uint8_t>(c));
+	}
+	writer.u32(Snapshot::version);
+
+	// member identifiers, in symbol order
+	const SymbolTable &member_symbols = meta_info.get_member_symbols();
+	writer.size(member_symbols.size());
+	for (symbol_t member = 0; member < member_symbols.size(); member++) {
+		writer.str(member_symbols.get_name(member));
+	}
+
+	// loaded namespaces
+	const auto &namespaces = meta_info.get_namespaces();
+	writer.size(namespaces.size());
+	for (auto &name : sorted_keys(namespaces)) {
+		writer.ns(namespaces.at(name));
+	}
+
+	// object metadata, in symbol order
+	const SymbolTable &object_symbols = meta_info.get_object_symbols();
+	writer.size(object_symbols.size());
+	for (symbol_t obj = 0; obj < object_symbols.size(); obj++) {
+		const ObjectInfo &info = meta_info.get_object(obj);
+
+		writer.str(object_symbols.get_name(obj));
+		writer.location(info.get_location());
+		writer.ns(info.get_namespace());
+
+		writer.u8(info.is_initial_patch());
+		const PatchInfo *patch = info.get_patch().get();
+		if (writer.shared(patch)) {
+			writer.str(patch->get_target());
+		}
+
+		const auto &inheritance_change = info.get_inheritance_change();
+		writer.size(inheritance_change.size());
+		for (auto &change : inheritance_change) {
+			writer.u8(static_cast<uint8_t>(change.get_type()));
+			writer.str(change.get_target());
+		}
+
+		const auto &members = info.get_members();
+		writer.size(members.size());
+		for (auto &member_id : sorted_keys(members)) {
+			const MemberInfo &member_info = members.at(member_id);
+			const Type *type = member_info.get_type().get();
+			if (unlikely(type == nullptr)) {
+				throw InternalError{"can't write snapshot of member without type"};
+			}
+
+			writer.str(member_id);
+			writer.location(member_info.get_location());
+			writer.u8(member_info.is_initial_def());
+			if (writer.shared(type)) {
+				Snapshot::write_type(writer, *type);
+			}
+		}
+
+		writer.strs(info.get_linearization());
+		writer.strs(sorted_keys(info.get_children()));
+	}
+
+	// initial object states, in symbol order
+	const State &state = *database.state;
+	for (symbol_t obj = 0; obj < object_symbols.size(); obj++) {
+		const std::shared_ptr<ObjectState> *obj_state = state.get(obj);
+		if (unlikely(obj_state == nullptr)) {
+			throw InternalError{"object has no initial state"};
+		}
+
+		writer.strs((*obj_state)->get_parents());
+
+		const auto &members = (*obj_state)->get_members();
+		writer.size(members.size());
+		for (symbol_t member_symbol : sorted_keys(members)) {
+			const Member &member = members.at(member_symbol);
+
+			writer.u32(member_symbol);
+			writer.u64(member.override_depth);
+			writer.u8(static_cast<uint8_t>(member.operation));
+			Snapshot::write_type(writer, member.declared_type);
+			write_value(writer, *member.value);
+		}
+	}
+
+	writer.flush();
+}
+
+
+std::shared_ptr<Database> Snapshot::read(std::istream &in) {
+	SnapshotReader reader{in};
+
+	for (char c : Snapshot::magic) {
+		if (unlikely(reader.u8() != static_cast<uint8_t>(c))) {
+			throw SnapshotError{"not a nyan database snapshot"};
+		}
+	}
+
+	uint32_t snapshot_version = reader.u32();
+	if (unlikely(snapshot_version != Snapshot::version)) {
+		throw SnapshotError{
+			"database snapshot has format version "
+			+ std::to_string(snapshot_version)
+			+ ", but only version "
+			+ std::to_string(Snapshot::version)
+			+ " is supported"};
+	}
+
+	auto database = Database::create();
+	MetaInfo &meta_info = database->meta_info;
+
+	size_t member_count = reader.size();
+	for (size_t i = 0; i < member_count; i++) {
+		meta_info.get_member_symbols().intern(reader.str());
+	}
+
+	size_t ns_count = reader.size();
+	for (size_t i = 0; i < ns_count; i++) {
+		meta_info.add_namespace(reader.ns());
+	}
+
+	size_t obj_count = reader.size();
+	if (unlikely(obj_count > std::numeric_limits<symbol_t>::max())) {
+		throw SnapshotError{"database snapshot has too many objects"};
+	}
+
+	for (size_t i = 0; i < obj_count; i++) {
+		fqon_t name = reader.str();
+		Location location = reader.location();
+		ObjectInfo info{location, reader.ns()};
+
+		bool initial_patch = reader.u8();
+		auto patch = reader.shared(reader.patches, [&reader]() {
+			return std::make_shared<PatchInfo>(reader.str());
+		});
+		if (patch != nullptr) {
+			info.add_patch(patch, initial_patch);
+		}
+
+		size_t change_count = reader.size();
+		for (size_t j = 0; j < change_count; j++) {
+			auto type = static_cast<inher_change_t>(reader.u8());
+			info.add_inheritance_change(InheritanceChange{type, reader.str()});
+		}
+
+		size_t obj_member_count = reader.size();
+		for (size_t j = 0; j < obj_member_count; j++) {
+			memberid_t member_id = reader.str();
+			MemberInfo &member_info = info.add_member(member_id, MemberInfo{reader.location()});
+
+			bool initial_def = reader.u8();
+			auto type = reader.shared(reader.types, [&reader]() {
+				return std::make_shared<Type>(Snapshot::read_type(reader));
+			});
+			if (unlikely(type == nullptr)) {
+				throw SnapshotError{"database snapshot has a member without type"};
+			}
+			member_info.set_type(std::move(type), initial_def);
+		}
+
+		std::vector<std::string> lin = reader.strs();
+		info.set_linearization(std::move(lin));
+
+		std::vector<std::string> children = reader.strs();
+		info.set_children({std::make_move_iterator(std::begin(children)),
+		                   std::make_move_iterator(std::end(children))});
+
+		// the objects were written in symbol order, so they get the same symbols.
+		meta_info.add_object(name, std::move(info));
+	}
+
+	for (symbol_t obj = 0; obj < obj_count; obj++) {
+		std::vector<std::string> parents = reader.strs();
+		auto obj_state = std::make_shared<ObjectState>(
+			std::deque<fqon_t>{std::make_move_iterator(std::begin(parents)),
+		                       std::make_move_iterator(std::end(parents))});
+
+		std::unordered_map<symbol_t, Member> members;
+		size_t obj_member_count = reader.size();
+		for (size_t j = 0; j < obj_member_count; j++) {
+			symbol_t member_symbol = reader.u32();
+			if (unlikely(member_symbol >= member_count)) {
+				throw SnapshotError{"database snapshot references an unknown member"};
+			}
+
+			auto depth = static_cast<override_depth_t>(reader.u64());
+			auto operation = static_cast<nyan_op>(reader.u8());
+			Type declared_type = Snapshot::read_type(reader);
+			members.emplace(
+				member_symbol,
+				Member{depth, operation, std::move(declared_type), read_value(reader)});
+		}
+		obj_state->set_members(std::move(members));
+
+		database->state->add_object(obj, std::move(obj_state));
+	}
+
+	// the lineages are cheap to derive from the linearizations.
+	for (symbol_t obj = 0; obj < obj_count; obj++) {
+		ObjectInfo &info = *meta_info.get_object(meta_info.get_object_symbols().get_name(obj));
+		info.set_lineage(
+			Lineage{
+				info.get_linearization(),
+				meta_info,
+				[&database](symbol_t parent) -> const ObjectState & {
+					const std::shared_ptr<ObjectState> *parent_state = database->state->get(parent);
+					if (unlikely(parent_state == nullptr)) {
+						throw SnapshotError{"database snapshot has an object without state"};
+					}
+					return **parent_state;
+				}});
+	}
+
+	return database;
+}
+
+
+namespace {
+
+void write_value(SnapshotWriter &writer, const Value &value) {
+	if (dynamic_cast<const None *>(&value) != nullptr) {
+		writer.u8(static_cast<uint8_t>(value_tag::NONE));
+	}
+	else if (auto *val = dynamic_cast<const Boolean *>(&value)) {
+		writer.u8(static_cast<uint8_t>(value_tag::BOOLEAN));
+		writer.u8(val->get());
+	}
+	else if (auto *val = dynamic_cast<const Text *>(&value)) {
+		writer.u8(static_cast<uint8_t>(value_tag::TEXT));
+		writer.str(val->get());
+	}
+	else if (auto *val = dynamic_cast<const Filename *>(&value)) {
+		writer.u8(static_cast<uint8_t>(value_tag::FILENAME));
+		writer.str(val->get());
+	}
+	else if (auto *val = dynamic_cast<const Int *>(&value)) {
+		writer.u8(static_cast<uint8_t>(value_tag::INT));
+		writer.u64(static_cast<uint64_t>(val->get()));
+	}
+	else if (auto *val = dynamic_cast<const Float *>(&value)) {
+		writer.u8(static_cast<uint8_t>(value_tag::FLOAT));
+		writer.u64(std::bit_cast<uint64_t>(val->get()));
+	}
+	else if (auto *val = dynamic_cast<const ObjectValue *>(&value)) {
+		writer.u8(static_cast<uint8_t>(value_tag::OBJECT));
+		writer.str(val->get_name());
+	}
+	else if (auto *val = dynamic_cast<const Set *>(&value)) {
+		writer.u8(static_cast<uint8_t>(value_tag::SET));
+		writer.size(val->size());
+		for (auto &elem : val->get()) {
+			write_value(writer, *elem);
+		}
+	}
+	else if (auto *val = dynamic_cast<const OrderedSet *>(&value)) {
+		writer.u8(static_cast<uint8_t>(value_tag::ORDEREDSET));
+		writer.size(val->size());
+		for (auto &elem : val->get()) {
+			write_value(writer, *elem);
+		}
+	}
+	else if (auto *val = dynamic_cast<const Dict *>(&value)) {
+		writer.u8(static_cast<uint8_t>(value_tag::DICT));
+		writer.size(val->size());
+		for (auto &it : val->get()) {
+			write_value(writer, *it.first);
+			write_value(writer, *it.second);
+		}
+	}
+	else {
+		throw InternalError{"can't write snapshot of value " + value.repr()};
+	}
+}
+
+
+ValueHolder read_value(SnapshotReader &reader) {
+	auto tag = static_cast<value_tag>(reader.u8());
+	switch (tag) {
+	case value_tag::NONE:
+		return {None::value};
+	case value_tag::BOOLEAN:
+		return {std::make_shared<Boolean>(reader.u8() != 0)};
+	case value_tag::TEXT:
+		return {std::make_shared<Text>(reader.str())};
+	case value_tag::FILENAME:
+		return {std::make_shared<Filename>(reader.str())};
+	case value_tag::INT:
+		return {std::make_shared<Int>(static_cast<value_int_t>(reader.u64()))};
+	case value_tag::FLOAT:
+		return {std::make_shared<Float>(std::bit_cast<value_float_t>(reader.u64()))};
+	case value_tag::OBJECT:
+		return {std::make_shared<ObjectValue>(reader.str())};
+	case value_tag::SET:
+	case value_tag::ORDEREDSET: {
+		std::vector<ValueHolder> values;
+		size_t count = reader.size();
+		for (size_t i = 0; i < count; i++) {
+			values.push_back(read_value(reader));
+		}
+
+		if (tag == value_tag::SET) {
+			return {std::make_shared<Set>(std::move(values))};
+		}
+		return {std::make_shared<OrderedSet>(std::move(values))};
+	}
+	case value_tag::DICT: {
+		std::unordered_map<ValueHolder, ValueHolder> values;
+		size_t count = reader.size();
+		for (size_t i = 0; i < count; i++) {
+			ValueHolder key = read_value(reader);
+			values.emplace(std::move(key), read_value(reader));
+		}
+		return {std::make_shared<Dict>(std::move(values))};
+	}
+	}
+
+	throw SnapshotError{"database snapshot has an unknown value type"};
+}
+
+} // namespace
+
+} // namespace nyan
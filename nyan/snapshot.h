@@ -0,0 +1,72 @@
+// Copyright 2026-2026 the nyan authors, LGPLv3+. See copying.md for legal info.
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+
+
+namespace nyan {
+
+class Database;
+class Type;
+
+
+/**
+ * Binary snapshot of a loaded database.
+ *
+ * Contains the metadata information (objects, members, types, namespaces),
+ * the initial database state and the source files for error messages.
+ * Restoring a snapshot skips lexing, parsing, linearizing and validating
+ * the nyan files, they were already checked when the database was loaded.
+ *
+ * The format is versioned: snapshots written by a different format
+ * version are rejected and have to be recreated from the nyan files.
+ */
+class Snapshot {
+public:
+	/**
+	 * Identifies the file as nyan snapshot.
+	 */
+	static constexpr char magic[8] = {'n', 'y', 'a', 'n', 's', 'n', 'a', 'p'};
+
+	/**
+	 * Version of the snapshot format.
+	 * Increment on every change of the format.
+	 */
+	static constexpr uint32_t version = 1;
+
+	/**
+	 * Write the content of a database to a snapshot.
+	 * Throws a SnapshotError if the output stream fails.
+	 *
+	 * @param database Loaded database.
+	 * @param out Binary output stream the snapshot is written to.
+	 */
+	static void write(const Database &database, std::ostream &out);
+
+	/**
+	 * Restore a database from a snapshot.
+	 * Throws a SnapshotError if the snapshot is broken or has another version.
+	 *
+	 * @param in Binary input stream the snapshot is read from.
+	 *
+	 * @return The restored database.
+	 */
+	static std::shared_ptr<Database> read(std::istream &in);
+
+protected:
+	/**
+	 * Write a type including its nested element types.
+	 */
+	template <typename W>
+	static void write_type(W &writer, const Type &type);
+
+	/**
+	 * Read a type written by write_type().
+	 */
+	template <typename R>
+	static Type read_type(R &reader);
+};
+
+} // namespace nyan
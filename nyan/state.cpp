@@ -6,6 +6,7 @@
 
 #include "compiler.h"
 #include "error.h"
+#include "meta_info.h"
 #include "object_state.h"
 #include "util.h"
 #include "view.h"
@@ -21,8 +22,8 @@ State::State() :
 	previous_state{nullptr} {}
 
 
-const std::shared_ptr<ObjectState> *State::get(const fqon_t &fqon) const {
-	auto it = this->objects.find(fqon);
+const std::shared_ptr<ObjectState> *State::get(symbol_t obj) const {
+	auto it = this->objects.find(obj);
 	if (it != std::end(this->objects)) {
 		return &it->second;
 	}
@@ -32,7 +33,7 @@ const std::shared_ptr<ObjectState> *State::get(const fqon_t &fqon) const {
 }
 
 
-ObjectState &State::add_object(const fqon_t &name, std::shared_ptr<ObjectState> &&obj) {
+ObjectState &State::add_object(symbol_t name, std::shared_ptr<ObjectState> &&obj) {
 	if (unlikely(this->previous_state != nullptr)) {
 		throw InternalError{"can't add new object in state that is not initial."};
 	}
@@ -63,7 +64,7 @@ void State::update(std::shared_ptr<State> &&source_state) {
 }
 
 
-const std::shared_ptr<ObjectState> &State::copy_object(const fqon_t &name,
+const std::shared_ptr<ObjectState> &State::copy_object(symbol_t name,
                                                        order_t t,
                                                        std::shared_ptr<View> &origin) {
 	// last known state of the object
@@ -87,18 +88,23 @@ const std::shared_ptr<ObjectState> &State::copy_object(const fqon_t &name,
 }
 
 
+void State::set_object(symbol_t name, const std::shared_ptr<ObjectState> &obj) {
+	this->objects.insert_or_assign(name, obj);
+}
+
+
 const std::shared_ptr<State> &State::get_previous_state() const {
 	return this->previous_state;
 }
 
 
-const std::unordered_map<fqon_t, std::shared_ptr<ObjectState>> &
+const std::unordered_map<symbol_t, std::shared_ptr<ObjectState>> &
 State::get_objects() const {
 	return this->objects;
 }
 
 
-std::string State::str() const {
+std::string State::str(const MetaInfo &meta_info) const {
 	std::ostringstream builder;
 
 	builder << "State:" << std::endl;
@@ -106,7 +112,8 @@ std::string State::str() const {
 	size_t i = 0;
 	for (auto &it : this->objects) {
 		builder << "object " << i << ":" << std::endl
-				<< it.first << " => " << it.second->str() << std::endl;
+				<< meta_info.get_object_symbols().get_name(it.first)
+				<< " => " << it.second->str(meta_info) << std::endl;
 		i += 1;
 	}
 
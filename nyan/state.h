@@ -10,6 +10,7 @@
 
 namespace nyan {
 
+class MetaInfo;
 class ObjectState;
 class View;
 
@@ -26,25 +27,25 @@ public:
 	State();
 
 	/**
-	 * Get an object state for a given object identifier name.
+	 * Get an object state for a given object.
 	 *
-	 * @param fqon Identifier of the object.
+	 * @param obj Symbol of the object identifier.
 	 *
 	 * @return Shared pointer to the object state if it exists, else nullptr.
 	 */
-	const std::shared_ptr<ObjectState> *get(const fqon_t &fqon) const;
+	const std::shared_ptr<ObjectState> *get(symbol_t obj) const;
 
 	/**
 	 * Add an object state to the database state. This can only be done for the initial
 	 * state, i.e. there's no previous state. Why? The database must be filled
 	 * at some point.
 	 *
-	 * @param fqon Identifier of the object.
+	 * @param name Symbol of the object identifier.
 	 * @param obj Shared pointer to the state of the object.
 	 *
 	 * @return ObjectState that was added to the state.
 	 */
-	ObjectState &add_object(const fqon_t &name, std::shared_ptr<ObjectState> &&obj);
+	ObjectState &add_object(symbol_t name, std::shared_ptr<ObjectState> &&obj);
 
 	/**
 	 * Add and potentially replace the object states of this state by
@@ -58,16 +59,26 @@ public:
 	 * Copy an object state from an origin view to this state.
 	 * If it is in this state already, don't copy it.
 	 *
-	 * @param name Identifier of the object.
+	 * @param name Symbol of the object identifier.
 	 * @param t Time for the object state is retrieved.
 	 * @param origin View from which the object state is copied.
 	 *
 	 * @return Shared pointer to the object state.
 	 */
-	const std::shared_ptr<ObjectState> &copy_object(const fqon_t &name,
+	const std::shared_ptr<ObjectState> &copy_object(symbol_t name,
 	                                                order_t t,
 	                                                std::shared_ptr<View> &origin);
 
+	/**
+	 * Store a changed object state in this state, replacing the one
+	 * this state may already have. The object state can be shared
+	 * with other states that changed the object the same way.
+	 *
+	 * @param name Symbol of the object identifier.
+	 * @param obj Shared pointer to the new state of the object.
+	 */
+	void set_object(symbol_t name, const std::shared_ptr<ObjectState> &obj);
+
 	/**
 	 * Get the previous database state.
 	 *
@@ -79,23 +90,27 @@ public:
 	/**
 	 * Return the object states stored in this state.
 	 *
-	 * @return Map of shared pointers to object states by object identifier.
+	 * @return Map of shared pointers to object states by object symbol.
 	 */
-	const std::unordered_map<fqon_t, std::shared_ptr<ObjectState>> &
+	const std::unordered_map<symbol_t, std::shared_ptr<ObjectState>> &
 	get_objects() const;
 
 	/**
 	 * Get the string representation of this state.
 	 *
+	 * @param meta_info Metadata information of the database,
+	 *     used to print the object and member names.
+	 *
 	 * @return String representation of this state.
 	 */
-	std::string str() const;
+	std::string str(const MetaInfo &meta_info) const;
 
 private:
 	/**
 	 * Object states in the database state.
+	 * Keyed by the object symbols of the database MetaInfo.
 	 */
-	std::unordered_map<fqon_t, std::shared_ptr<ObjectState>> objects;
+	std::unordered_map<symbol_t, std::shared_ptr<ObjectState>> objects;
 
 	/**
 	 * Previous state.
@@ -2,6 +2,8 @@
 
 #include "state_history.h"
 
+#include <mutex>
+
 #include "compiler.h"
 #include "database.h"
 #include "meta_info.h"
@@ -32,16 +34,34 @@ const std::shared_ptr<State> *StateHistory::get_state_exact(order_t t) const {
 }
 
 
-const std::shared_ptr<ObjectState> *StateHistory::get_obj_state(const fqon_t &fqon, order_t t) const {
+const std::shared_ptr<ObjectState> *StateHistory::get_obj_state(symbol_t obj, order_t t) const {
+	// fast path: no state is newer than the requested time,
+	// so the newest object state is the one we search.
+	if (t >= this->history.last()->first) {
+		if (obj < this->head.size() and this->head[obj] != nullptr) {
+			return &this->head[obj];
+		}
+
+		// the object wasn't changed in this history.
+		return nullptr;
+	}
+
 	// get the object history
-	const ObjectHistory *obj_history = this->get_obj_history(fqon);
+	const ObjectHistory *obj_history = this->get_obj_history(obj);
 
 	// object isn't recorded in this state history
 	if (obj_history == nullptr) {
 		return nullptr;
 	}
 
-	std::optional<order_t> order = obj_history->last_change_before(t);
+	return this->get_obj_state(*obj_history, obj, t);
+}
+
+
+const std::shared_ptr<ObjectState> *StateHistory::get_obj_state(const ObjectHistory &obj_history,
+                                                                symbol_t obj,
+                                                                order_t t) const {
+	std::optional<order_t> order = obj_history.last_change_before(t);
 
 	if (not order) {
 		// the change is earlier than what is recorded in this history.
@@ -54,8 +74,8 @@ const std::shared_ptr<ObjectState> *StateHistory::get_obj_state(const fqon_t &fq
 		throw InternalError{"no history record at change point"};
 	}
 
-	const std::shared_ptr<ObjectState> *obj_state = (*state)->get(fqon);
-	if (unlikely(state == nullptr)) {
+	const std::shared_ptr<ObjectState> *obj_state = (*state)->get(obj);
+	if (unlikely(obj_state == nullptr)) {
 		throw InternalError{"object state not found at change point"};
 	}
 
@@ -64,26 +84,104 @@ const std::shared_ptr<ObjectState> *StateHistory::get_obj_state(const fqon_t &fq
 
 
 void StateHistory::insert(std::shared_ptr<State> &&new_state, order_t t) {
+	// are states later than the new one dropped?
+	const auto *last = this->history.last();
+	bool drops_later = (last != nullptr and last->first > t);
+
+	if (drops_later) {
+		for (auto &it : this->object_obj_hists) {
+			// forget the records of the dropped states.
+			it.second.drop_after(t);
+
+			// values calculated from the dropped states are outdated.
+			it.second.invalidate_values(t);
+		}
+	}
+
 	// record the changes.
 	for (const auto &it : new_state->get_objects()) {
 		ObjectHistory &obj_history = this->get_create_obj_history(it.first);
 		obj_history.insert_change(t);
+
+		if (not drops_later) {
+			// the new state is the newest one.
+			if (it.first >= this->head.size()) {
+				this->head.resize(it.first + 1);
+			}
+			this->head[it.first] = it.second;
+		}
 	}
 
 	// drop all later changes
 	this->history.insert_drop(t, std::move(new_state));
+
+	if (drops_later) {
+		this->rebuild_head();
+	}
 }
 
 
-void StateHistory::insert_linearization(std::vector<fqon_t> &&ins, order_t t) {
-	const auto &obj = ins.at(0);
+void StateHistory::copy_at(const StateHistory &source, order_t t) {
+	// the new history only has its initial state,
+	// which follows the database state.
+	const std::shared_ptr<State> &initial = this->get_state(DEFAULT_T);
+	auto pinned = std::make_shared<State>(initial->get_previous_state());
+
+	// queries of the source may add object histories and cache entries
+	// meanwhile, the lock makes them wait until the copy is done.
+	std::shared_lock<std::shared_mutex> lock{source.cache_mutex};
+
+	for (auto &it : source.object_obj_hists) {
+		const std::shared_ptr<ObjectState> *obj_state = source.get_obj_state(it.second, it.first, t);
+		if (obj_state != nullptr) {
+			pinned->set_object(it.first, *obj_state);
+		}
+	}
+
+	this->insert(std::move(pinned), DEFAULT_T);
+
+	for (auto &it : source.object_obj_hists) {
+		const ObjectHistory &obj_hist = it.second;
 
-	this->get_create_obj_history(obj).linearizations.insert_drop(t, std::move(ins));
+		if (not obj_hist.linearizations.empty()) {
+			const std::vector<fqon_t> *lin = obj_hist.linearizations.at_find(t);
+			const Lineage *lineage = obj_hist.lineages.at_find(t);
+			if (lin != nullptr and lineage != nullptr) {
+				ObjectHistory &pinned_hist = this->get_create_obj_history(it.first);
+				pinned_hist.linearizations.insert_drop(DEFAULT_T, std::vector<fqon_t>{*lin});
+				pinned_hist.lineages.insert_drop(DEFAULT_T, Lineage{*lineage});
+			}
+		}
+
+		if (not obj_hist.children.empty()) {
+			const std::unordered_set<fqon_t> *children = obj_hist.children.at_find(t);
+			if (children != nullptr) {
+				this->get_create_obj_history(it.first).children.insert_drop(
+					DEFAULT_T,
+					std::unordered_set<fqon_t>{*children});
+			}
+		}
+	}
+}
+
+
+void StateHistory::freeze() {
+	this->frozen = true;
+}
+
+
+void StateHistory::insert_linearization(symbol_t obj,
+                                        std::vector<fqon_t> &&ins,
+                                        Lineage &&lineage,
+                                        order_t t) {
+	ObjectHistory &obj_history = this->get_create_obj_history(obj);
+	obj_history.linearizations.insert_drop(t, std::move(ins));
+	obj_history.lineages.insert_drop(t, std::move(lineage));
 }
 
 
 const std::vector<fqon_t> &
-StateHistory::get_linearization(const fqon_t &obj, order_t t, const MetaInfo &meta_info) const {
+StateHistory::get_linearization(symbol_t obj, order_t t, const MetaInfo &meta_info) const {
 	const ObjectHistory *obj_hist = this->get_obj_history(obj);
 	if (obj_hist != nullptr) {
 		if (not obj_hist->linearizations.empty()) {
@@ -96,24 +194,52 @@ StateHistory::get_linearization(const fqon_t &obj, order_t t, const MetaInfo &me
 	}
 
 	// otherwise, the lin is only stored in the database.
-	const ObjectInfo *obj_info = meta_info.get_object(obj);
-	if (unlikely(obj_info == nullptr)) {
-		throw InternalError{"object not found in metainfo"};
+	return meta_info.get_object(obj).get_linearization();
+}
+
+
+const Lineage &
+StateHistory::get_lineage(symbol_t obj, order_t t, const MetaInfo &meta_info) const {
+	const ObjectHistory *obj_hist = this->get_obj_history(obj);
+	if (obj_hist != nullptr) {
+		if (not obj_hist->lineages.empty()) {
+			auto ret = obj_hist->lineages.at_find(t);
+
+			if (ret != nullptr) {
+				return *ret;
+			}
+		}
 	}
 
-	return obj_info->get_linearization();
+	// otherwise, the lineage is only stored in the database.
+	return meta_info.get_object(obj).get_lineage();
 }
 
 
-void StateHistory::insert_children(const fqon_t &obj,
+void StateHistory::insert_children(symbol_t obj,
                                    std::unordered_set<fqon_t> &&ins,
-                                   order_t t) {
+                                   order_t t,
+                                   const MetaInfo &meta_info) {
 	this->get_create_obj_history(obj).children.insert_drop(t, std::move(ins));
+
+	// the object and all its ancestors have new descendants now.
+	// the linearization starts with the object itself.
+	for (auto &ancestor : this->get_linearization(obj, t, meta_info)) {
+		const symbol_t *ancestor_symbol = meta_info.get_object_symbol(ancestor);
+		if (unlikely(ancestor_symbol == nullptr)) {
+			throw InternalError{"ancestor object not in database"};
+		}
+
+		ObjectHistory *obj_hist = this->get_obj_history(*ancestor_symbol);
+		if (obj_hist != nullptr) {
+			obj_hist->invalidate_descendants(t);
+		}
+	}
 }
 
 
 const std::unordered_set<fqon_t> &
-StateHistory::get_children(const fqon_t &obj, order_t t, const MetaInfo &meta_info) const {
+StateHistory::get_children(symbol_t obj, order_t t, const MetaInfo &meta_info) const {
 	// first try the obj_history
 	const ObjectHistory *obj_hist = this->get_obj_history(obj);
 	if (obj_hist != nullptr) {
@@ -127,27 +253,112 @@ StateHistory::get_children(const fqon_t &obj, order_t t, const MetaInfo &meta_in
 	}
 
 	// otherwise, the lin is only stored in the database.
-	const ObjectInfo *obj_info = meta_info.get_object(obj);
-	if (unlikely(obj_info == nullptr)) {
-		throw InternalError{"object not found in metainfo"};
+	return meta_info.get_object(obj).get_children();
+}
+
+
+std::optional<ValueHolder> StateHistory::get_value(symbol_t obj,
+                                                   symbol_t member,
+                                                   order_t t) const {
+	// the value is copied while the lock is held,
+	// as other threads may insert values into the same curve.
+	std::shared_lock<std::shared_mutex> lock{this->cache_mutex};
+
+	auto it = this->object_obj_hists.find(obj);
+	if (it == std::end(this->object_obj_hists)) {
+		return std::nullopt;
 	}
 
-	return obj_info->get_children();
+	const ValueHolder *value = it->second.get_value(member, t);
+	if (value == nullptr) {
+		return std::nullopt;
+	}
+
+	return *value;
 }
 
 
-ObjectHistory *StateHistory::get_obj_history(const fqon_t &obj) {
-	auto it = this->object_obj_hists.find(obj);
-	if (it != std::end(this->object_obj_hists)) {
-		return &it->second;
+void StateHistory::insert_value(symbol_t obj,
+                                symbol_t member,
+                                order_t t,
+                                const ValueHolder &value) {
+	std::unique_lock<std::shared_mutex> lock{this->cache_mutex};
+	this->object_obj_hists[obj].insert_value(member, t, value);
+}
+
+
+void StateHistory::invalidate_values(symbol_t obj, order_t t) {
+	ObjectHistory *obj_hist = this->get_obj_history(obj);
+	if (obj_hist != nullptr) {
+		obj_hist->invalidate_values(t);
 	}
-	else {
+}
+
+
+const std::unordered_set<fqon_t> *StateHistory::get_descendants(symbol_t obj, order_t t) const {
+	std::shared_lock<std::shared_mutex> lock{this->cache_mutex};
+
+	auto it = this->object_obj_hists.find(obj);
+	if (it == std::end(this->object_obj_hists)) {
 		return nullptr;
 	}
+
+	return it->second.get_descendants(t);
 }
 
 
-const ObjectHistory *StateHistory::get_obj_history(const fqon_t &obj) const {
+const std::unordered_set<fqon_t> &StateHistory::insert_descendants(symbol_t obj,
+                                                                   order_t t,
+                                                                   std::unordered_set<fqon_t> &&ins) {
+	std::unique_lock<std::shared_mutex> lock{this->cache_mutex};
+	ObjectHistory &obj_hist = this->object_obj_hists[obj];
+
+	// replacing the descendants would invalidate
+	// the reference another thread got for them.
+	const std::unordered_set<fqon_t> *known = obj_hist.get_descendants(t);
+	if (known != nullptr) {
+		return *known;
+	}
+
+	return obj_hist.insert_descendants(t, std::move(ins));
+}
+
+
+void StateHistory::rebuild_head() {
+	this->head.clear();
+
+	for (auto &it : this->object_obj_hists) {
+		symbol_t obj = it.first;
+		std::optional<order_t> order = it.second.last_change_before(LATEST_T);
+		if (not order) {
+			continue;
+		}
+
+		const std::shared_ptr<State> *state = this->history.at_exact(*order);
+		if (unlikely(state == nullptr)) {
+			throw InternalError{"no history record at change point"};
+		}
+
+		const std::shared_ptr<ObjectState> *obj_state = (*state)->get(obj);
+		if (unlikely(obj_state == nullptr)) {
+			throw InternalError{"object state not found at change point"};
+		}
+
+		if (obj >= this->head.size()) {
+			this->head.resize(obj + 1);
+		}
+		this->head[obj] = *obj_state;
+	}
+}
+
+
+ObjectHistory *StateHistory::get_obj_history(symbol_t obj) {
+	// entries are never removed, so the pointer stays valid after unlocking.
+	std::shared_lock<std::shared_mutex> lock{this->cache_mutex, std::defer_lock};
+	if (not this->frozen) {
+		lock.lock();
+	}
+
 	auto it = this->object_obj_hists.find(obj);
 	if (it != std::end(this->object_obj_hists)) {
 		return &it->second;
@@ -158,16 +369,27 @@ const ObjectHistory *StateHistory::get_obj_history(const fqon_t &obj) const {
 }
 
 
-ObjectHistory &StateHistory::get_create_obj_history(const fqon_t &obj) {
+const ObjectHistory *StateHistory::get_obj_history(symbol_t obj) const {
+	std::shared_lock<std::shared_mutex> lock{this->cache_mutex, std::defer_lock};
+	if (not this->frozen) {
+		lock.lock();
+	}
+
 	auto it = this->object_obj_hists.find(obj);
 	if (it != std::end(this->object_obj_hists)) {
-		return it->second;
+		return &it->second;
 	}
 	else {
-		// create new obj_history entry.
-		auto it_new_entry = this->object_obj_hists.emplace(obj, ObjectHistory{}).first;
-		return it_new_entry->second;
+		return nullptr;
 	}
 }
 
+
+ObjectHistory &StateHistory::get_create_obj_history(symbol_t obj) {
+	std::unique_lock<std::shared_mutex> lock{this->cache_mutex};
+
+	// creates a new obj_history entry if there is none.
+	return this->object_obj_hists[obj];
+}
+
 } // namespace nyan
@@ -2,8 +2,11 @@
 #pragma once
 
 #include <memory>
+#include <optional>
+#include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "config.h"
 #include "object_history.h"
@@ -19,6 +22,11 @@ class State;
 
 /**
  * Object state history tracking.
+ *
+ * Queries may fill the value and descendant caches from several threads
+ * at once, those writes are guarded by cache_mutex. All other records
+ * only change when a transaction is committed.
+ * A frozen history doesn't change anymore and is queried without locking.
  */
 class StateHistory {
 public:
@@ -53,14 +61,17 @@ public:
 
 	/**
 	 * Get an object state at a given time.
+	 * Queries at or after the latest recorded state are answered
+	 * from the head index with a single lookup.
 	 *
-	 * @param fqon Identifier of the object.
+	 * @param obj Symbol of the object identifier.
 	 * @param t Time for which the object state is retrieved.
 	 *
 	 * @return Shared pointer to the ObjectState at time \p t if
-	 *     it exists, else the next state before that.
+	 *     it exists, else the next state before that. nullptr if
+	 *     the object was not changed in this history until then.
 	 */
-	const std::shared_ptr<ObjectState> *get_obj_state(const fqon_t &fqon, order_t t) const;
+	const std::shared_ptr<ObjectState> *get_obj_state(symbol_t obj, order_t t) const;
 
 	/**
 	 * Record all changes of a new state in the history.
@@ -70,74 +81,189 @@ public:
 	 */
 	void insert(std::shared_ptr<State> &&new_state, order_t t);
 
+	/**
+	 * Fill a new history with the content of another history at a given time.
+	 * The object states, linearizations and children that the source
+	 * has at time t are stored at DEFAULT_T, so they're valid for all times.
+	 * The object states are shared with the source, not copied.
+	 *
+	 * @param source History to take the content from.
+	 * @param t Time of the content.
+	 */
+	void copy_at(const StateHistory &source, order_t t);
+
+	/**
+	 * Make the history read-only. Afterwards it must not be changed,
+	 * its caches must not be filled and queries don't lock cache_mutex.
+	 * The history must not be queried concurrently while freezing it.
+	 */
+	void freeze();
+
 	/**
 	 * Record a change to the linearization of an object in its history.
 	 *
+	 * @param obj Symbol of the object identifier.
 	 * @param ins New linearization of the object. The first element in
 	 *     the list is also the identifier of the object.
+	 * @param lineage Lineage derived from the new linearization.
 	 * @param t Time of insertion.
 	 */
-	void insert_linearization(std::vector<fqon_t> &&ins, order_t t);
+	void insert_linearization(symbol_t obj,
+	                          std::vector<fqon_t> &&ins,
+	                          Lineage &&lineage,
+	                          order_t t);
 
 	/**
 	 * Get the linearization of an object at a given time.
 	 *
-	 * @param obj Identifier of the object.
+	 * @param obj Symbol of the object identifier.
 	 * @param t Time for which the object linearization is retrieved.
 	 * @param meta_info Metadata information of the database.
 	 *
 	 * @return C3 linearization of the object.
 	 */
-	const std::vector<fqon_t> &get_linearization(const fqon_t &obj, order_t t, const MetaInfo &meta_info) const;
+	const std::vector<fqon_t> &get_linearization(symbol_t obj, order_t t, const MetaInfo &meta_info) const;
+
+	/**
+	 * Get the lineage of an object at a given time.
+	 *
+	 * @param obj Symbol of the object identifier.
+	 * @param t Time for which the object lineage is retrieved.
+	 * @param meta_info Metadata information of the database.
+	 *
+	 * @return Lineage of the object.
+	 */
+	const Lineage &get_lineage(symbol_t obj, order_t t, const MetaInfo &meta_info) const;
 
 	/**
 	 * Record a change to the children of an object in its history.
+	 * The linearization of the object at \p t must already be recorded,
+	 * as the cached descendants of all its ancestors become invalid.
 	 *
-	 * @param obj Identifier of the object.
+	 * @param obj Symbol of the object identifier.
 	 * @param ins New children of the object.
 	 * @param t Time of insertion.
+	 * @param meta_info Metadata information of the database.
 	 */
-	void insert_children(const fqon_t &obj, std::unordered_set<fqon_t> &&ins, order_t t);
+	void insert_children(symbol_t obj,
+	                     std::unordered_set<fqon_t> &&ins,
+	                     order_t t,
+	                     const MetaInfo &meta_info);
 
 	/**
 	 * Get the children of an object at a given time.
 	 *
-	 * @param obj Identifier of the object.
+	 * @param obj Symbol of the object identifier.
 	 * @param t Time for which the object children are retrieved.
 	 * @param meta_info Metadata information of the database.
 	 *
 	 * @return List of children of the object.
 	 */
-	const std::unordered_set<fqon_t> &get_children(const fqon_t &obj, order_t t, const MetaInfo &meta_info) const;
+	const std::unordered_set<fqon_t> &get_children(symbol_t obj, order_t t, const MetaInfo &meta_info) const;
+
+	/**
+	 * Get a cached member value of an object at a given time.
+	 *
+	 * @param obj Symbol of the object identifier.
+	 * @param member Symbol of the member identifier.
+	 * @param t Time for which the value is retrieved.
+	 *
+	 * @return The cached value if it is valid at time \p t, else nothing.
+	 */
+	std::optional<ValueHolder> get_value(symbol_t obj, symbol_t member, order_t t) const;
+
+	/**
+	 * Store a calculated member value of an object in the value cache.
+	 *
+	 * @param obj Symbol of the object identifier.
+	 * @param member Symbol of the member identifier.
+	 * @param t Time for which the value was calculated.
+	 * @param value Calculated value.
+	 */
+	void insert_value(symbol_t obj, symbol_t member, order_t t, const ValueHolder &value);
+
+	/**
+	 * Mark the cached values of an object as outdated from a given time on.
+	 *
+	 * @param obj Symbol of the object identifier.
+	 * @param t Time from which on the cached values are invalid.
+	 */
+	void invalidate_values(symbol_t obj, order_t t);
+
+	/**
+	 * Get the cached transitive children of an object at a given time.
+	 *
+	 * @param obj Symbol of the object identifier.
+	 * @param t Time for which the descendants are retrieved.
+	 *
+	 * @return Pointer to the cached descendants if they are valid at time \p t, else nullptr.
+	 */
+	const std::unordered_set<fqon_t> *get_descendants(symbol_t obj, order_t t) const;
+
+	/**
+	 * Store the gathered transitive children of an object.
+	 * If another thread stored them for this time in the meantime,
+	 * those are kept, so handed out references stay valid.
+	 *
+	 * @param obj Symbol of the object identifier.
+	 * @param t Time for which the descendants were gathered.
+	 * @param ins All transitive children of the object.
+	 *
+	 * @return The stored descendants, valid until the next state insertion.
+	 */
+	const std::unordered_set<fqon_t> &insert_descendants(symbol_t obj,
+	                                                     order_t t,
+	                                                     std::unordered_set<fqon_t> &&ins);
 
 protected:
 	/**
 	 * Get the object history an an object in the database.
 	 *
-	 * @param obj Identifier of the object.
+	 * @param obj Symbol of the object identifier.
 	 *
 	 * @return Pointer to the ObjectHistory of the object if it exists, else nullptr.
 	 */
-	ObjectHistory *get_obj_history(const fqon_t &obj);
+	ObjectHistory *get_obj_history(symbol_t obj);
 
 	/**
 	 * Get the object history an an object in the database.
 	 *
-	 * @param obj Identifier of the object.
+	 * @param obj Symbol of the object identifier.
 	 *
 	 * @return Pointer to the ObjectHistory of the object if it exists, else nullptr.
 	 */
-	const ObjectHistory *get_obj_history(const fqon_t &obj) const;
+	const ObjectHistory *get_obj_history(symbol_t obj) const;
 
 	/**
 	 * Get the object history an an object in the database or create it if
 	 * it doesn't exist.
 	 *
-	 * @param obj Identifier of the object.
+	 * @param obj Symbol of the object identifier.
 	 *
 	 * @return Pointer to the ObjectHistory of the object.
 	 */
-	ObjectHistory &get_create_obj_history(const fqon_t &obj);
+	ObjectHistory &get_create_obj_history(symbol_t obj);
+
+	/**
+	 * Get an object state at a given time from the history of the object.
+	 *
+	 * @param obj_history Change history of the object.
+	 * @param obj Symbol of the object identifier.
+	 * @param t Time for which the object state is retrieved.
+	 *
+	 * @return Shared pointer to the ObjectState at time \p t if
+	 *     it exists, else the next state before that. nullptr if
+	 *     the object was not changed in this history until then.
+	 */
+	const std::shared_ptr<ObjectState> *get_obj_state(const ObjectHistory &obj_history,
+	                                                  symbol_t obj,
+	                                                  order_t t) const;
+
+	/**
+	 * Recreate the head index from the object histories.
+	 * Required when states later than the newest one were dropped.
+	 */
+	void rebuild_head();
 
 	/**
 	 * Storage of states over time.
@@ -145,10 +271,28 @@ protected:
 	Curve<std::shared_ptr<State>> history;
 
 	/**
-	 * Information history for each object.
+	 * Information history for each object, by object symbol.
 	 * Optimizes searches in the history.
 	 */
-	std::unordered_map<fqon_t, ObjectHistory> object_obj_hists;
+	std::unordered_map<symbol_t, ObjectHistory> object_obj_hists;
+
+	/**
+	 * Guards the entries of object_obj_hists and the value and
+	 * descendant caches in them against concurrent queries.
+	 */
+	mutable std::shared_mutex cache_mutex;
+
+	/**
+	 * True if the history was made read-only with freeze().
+	 */
+	bool frozen = false;
+
+	/**
+	 * Newest state of each object, indexed by object symbol.
+	 * nullptr if the object was never changed in this history.
+	 * Valid for all times at or after the latest state in `history`.
+	 */
+	std::vector<std::shared_ptr<ObjectState>> head;
 };
 
 
@@ -0,0 +1,54 @@
+// Copyright 2026-2026 the nyan authors, LGPLv3+. See copying.md for legal info.
+
+#include "symbol_table.h"
+
+#include <limits>
+
+#include "compiler.h"
+#include "error.h"
+
+
+namespace nyan {
+
+
+symbol_t SymbolTable::intern(const std::string &name) {
+	auto it = this->lookup.find(name);
+	if (it != std::end(this->lookup)) {
+		return it->second;
+	}
+
+	if (unlikely(this->names.size() >= std::numeric_limits<symbol_t>::max())) {
+		throw InternalError{"symbol table is full"};
+	}
+
+	symbol_t symbol = static_cast<symbol_t>(this->names.size());
+	const std::string &stored = this->names.emplace_back(name);
+	this->lookup.emplace(stored, symbol);
+
+	return symbol;
+}
+
+
+const symbol_t *SymbolTable::find(const std::string &name) const {
+	auto it = this->lookup.find(name);
+	if (it == std::end(this->lookup)) {
+		return nullptr;
+	}
+	return &it->second;
+}
+
+
+const std::string &SymbolTable::get_name(symbol_t symbol) const {
+	if (unlikely(symbol >= this->names.size())) {
+		throw InternalError{"unknown symbol"};
+	}
+	return this->names[symbol];
+}
+
+
+size_t SymbolTable::size() const {
+	return this->names.size();
+}
+
+
+} // namespace nyan
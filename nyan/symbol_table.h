@@ -0,0 +1,80 @@
+// Copyright 2026-2026 the nyan authors, LGPLv3+. See copying.md for legal info.
+#pragma once
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "config.h"
+
+
+namespace nyan {
+
+
+/**
+ * Interning table that maps names to compact integer identifiers.
+ * Symbols are handed out in insertion order, starting at 0.
+ *
+ * Interning is not thread-safe, lookups are.
+ */
+class SymbolTable {
+public:
+	SymbolTable() = default;
+	~SymbolTable() = default;
+
+	// the lookup table points into the name storage
+	SymbolTable(const SymbolTable &other) = delete;
+	SymbolTable &operator=(const SymbolTable &other) = delete;
+
+	/**
+	 * Get the symbol of a name, create it if it doesn't exist yet.
+	 *
+	 * @param name Name to intern.
+	 *
+	 * @return Symbol of the name.
+	 */
+	symbol_t intern(const std::string &name);
+
+	/**
+	 * Get the symbol of an already interned name.
+	 *
+	 * @param name Name to search for.
+	 *
+	 * @return Pointer to the symbol if the name was interned, else nullptr.
+	 */
+	const symbol_t *find(const std::string &name) const;
+
+	/**
+	 * Get the name of a symbol.
+	 *
+	 * @param symbol Symbol created by this table.
+	 *
+	 * @return Name the symbol was created for.
+	 */
+	const std::string &get_name(symbol_t symbol) const;
+
+	/**
+	 * Get the number of interned names.
+	 * All symbols are smaller than this.
+	 *
+	 * @return Number of symbols in the table.
+	 */
+	size_t size() const;
+
+protected:
+	/**
+	 * Interned names, indexed by symbol.
+	 * A deque doesn't move its elements when growing,
+	 * so the lookup keys stay valid.
+	 */
+	std::deque<std::string> names;
+
+	/**
+	 * Maps the stored names to their symbols.
+	 */
+	std::unordered_map<std::string_view, symbol_t> lookup;
+};
+
+
+} // namespace nyan
@@ -11,42 +11,58 @@
 namespace nyan {
 
 
-Token::Token(const std::shared_ptr<File> &file,
-             int line,
-             int line_offset,
-             int length,
-             token_type type) :
-	location{file, line, line_offset, length},
-	type{type} {}
-
-
-Token::Token(const std::shared_ptr<File> &file,
+Token::Token(File *file,
              int line,
              int line_offset,
              int length,
              token_type type,
-             const std::string &value) :
-	location{file, line, line_offset, length},
+             size_t offset) :
 	type{type},
-	value{value} {}
+	file{file},
+	line{line},
+	line_offset{line_offset},
+	length{length},
+	offset{offset} {}
 
 
 Token::Token() :
-	type{token_type::INVALID} {}
+	type{token_type::INVALID},
+	file{nullptr},
+	line{0},
+	line_offset{0},
+	length{0},
+	offset{0} {}
+
 
+std::string_view Token::get() const {
+	if (this->file == nullptr or not token_needs_payload(this->type)) {
+		return {};
+	}
+
+	return this->file->get_content().substr(this->offset, this->length);
+}
+
+
+Location Token::get_location() const {
+	if (this->file == nullptr) {
+		return Location{};
+	}
 
-const std::string &Token::get() const {
-	return this->value;
+	return Location{
+		this->file->shared_from_this(),
+		this->line,
+		this->line_offset,
+		this->length};
 }
 
 
 std::string Token::str() const {
 	std::ostringstream builder;
-	builder << "(" << this->location.get_line() << ":"
-			<< this->location.get_line_offset() << ": "
+	builder << "(" << this->line << ":"
+			<< this->line_offset << ": "
 			<< token_type_str(this->type);
-	if (this->value.size() > 0) {
-		builder << " '" << this->value << "'";
+	if (this->get().size() > 0) {
+		builder << " '" << this->get() << "'";
 	}
 	builder << ")";
 	return builder.str();
@@ -2,7 +2,9 @@
 #pragma once
 
 
+#include <cstddef>
 #include <string>
+#include <string_view>
 
 #include "error.h"
 #include "location.h"
@@ -157,21 +159,32 @@ constexpr bool token_needs_payload(token_type type) {
 
 /**
  * Tokens are generated by the nyan lexer.
+ *
+ * The payload is not copied, the token refers to it in the file content.
+ * The file is not owned by the token: whoever stores tokens
+ * must keep the file alive, e.g. the AST does.
  */
 class Token {
 public:
 	Token();
-	Token(const std::shared_ptr<File> &file,
-	      int line,
-	      int line_offset,
-	      int length,
-	      token_type type);
-	Token(const std::shared_ptr<File> &file,
+
+	/**
+	 * Create a token for content in a file.
+	 *
+	 * @param file File the token is in.
+	 * @param line Line number of the token.
+	 * @param line_offset Start of the token in the line.
+	 * @param length Length of the token.
+	 * @param type Token type.
+	 * @param offset Start of the token in the file content,
+	 *     its payload if the token type needs one.
+	 */
+	Token(File *file,
 	      int line,
 	      int line_offset,
 	      int length,
 	      token_type type,
-	      const std::string &value);
+	      size_t offset = 0);
 	~Token() = default;
 
 	/**
@@ -199,21 +212,24 @@ public:
 	/**
 	 * Get the token payload.
 	 *
-	 * @return String of the token payload.
+	 * @return View on the token payload in the file content,
+	 *     empty if the token type has no payload.
 	 */
-	const std::string &get() const;
+	std::string_view get() const;
 
 	/**
-	 * Get the string representation of the token.
+	 * Get the location of the token in its file.
 	 *
-	 * @return String representation of the token.
+	 * @return Location of the token.
 	 */
-	std::string str() const;
+	Location get_location() const;
 
 	/**
-	 * Location of the token in a file.
+	 * Get the string representation of the token.
+	 *
+	 * @return String representation of the token.
 	 */
-	Location location;
+	std::string str() const;
 
 	/**
 	 * Token type.
@@ -222,9 +238,29 @@ public:
 
 protected:
 	/**
-	 * Token payload.
+	 * File the token is in.
+	 */
+	File *file;
+
+	/**
+	 * Line number of the token in the file.
+	 */
+	int line;
+
+	/**
+	 * Start of the token in the line.
+	 */
+	int line_offset;
+
+	/**
+	 * Length of the token.
+	 */
+	int length;
+
+	/**
+	 * Start of the token in the file content.
 	 */
-	std::string value;
+	size_t offset;
 };
 
 } // namespace nyan
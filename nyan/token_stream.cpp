@@ -4,14 +4,30 @@
 
 #include <iostream>
 
+#include "compiler.h"
+#include "lexer/lexer.h"
 #include "token.h"
 
 
 namespace nyan {
 
-TokenStream::TokenStream(const TokenStream::container_t &container) :
-	container{container},
-	iter{std::begin(container)} {}
+TokenStream::TokenStream(const TokenStream::container_t &container,
+                         std::pmr::memory_resource *resource) :
+	container{&container},
+	iter{std::begin(container)},
+	lexer{nullptr},
+	window_pos{0},
+	lexer_done{true},
+	resource{resource} {}
+
+
+TokenStream::TokenStream(Lexer &lexer,
+                         std::pmr::memory_resource *resource) :
+	container{nullptr},
+	lexer{&lexer},
+	window_pos{0},
+	lexer_done{false},
+	resource{resource} {}
 
 
 TokenStream::~TokenStream() = default;
@@ -24,17 +40,42 @@ const TokenStream::tok_t *TokenStream::next() {
 		throw InternalError{"requested item from empty list"};
 	}
 
-	ret = &(*this->iter);
+	if (this->lexer == nullptr) {
+		ret = &(*this->iter);
+
+		// std::cout << "tok: " << ret->str() << std::endl;
+
+		this->iter = std::next(this->iter);
+		return ret;
+	}
 
-	// std::cout << "tok: " << ret->str() << std::endl;
+	if (this->window_pos == this->window.size()) {
+		this->window.push_back(this->lexer->get_next_token());
+		if (this->window.back().type == token_type::ENDFILE) {
+			this->lexer_done = true;
+		}
+	}
+
+	ret = &this->window[this->window_pos];
+	this->window_pos += 1;
+
+	// forget tokens that can no longer be reinserted.
+	while (this->window_pos > history_size) {
+		this->window.pop_front();
+		this->window_pos -= 1;
+	}
 
-	this->iter = std::next(this->iter);
 	return ret;
 }
 
 
 bool TokenStream::full() const {
-	return this->iter != std::end(this->container);
+	if (this->lexer == nullptr) {
+		return this->iter != std::end(*this->container);
+	}
+
+	// the lexer ends every stream with the end of file token.
+	return this->window_pos < this->window.size() or not this->lexer_done;
 }
 
 
@@ -44,11 +85,25 @@ bool TokenStream::empty() const {
 
 
 void TokenStream::reinsert_last() {
-	if (this->iter == std::begin(this->container)) {
+	if (this->lexer == nullptr) {
+		if (this->iter == std::begin(*this->container)) {
+			throw InternalError{"requested reinsert of unavailable token"};
+		}
+
+		this->iter = std::prev(this->iter);
+		return;
+	}
+
+	if (unlikely(this->window_pos == 0)) {
 		throw InternalError{"requested reinsert of unavailable token"};
 	}
 
-	this->iter = std::prev(this->iter);
+	this->window_pos -= 1;
+}
+
+
+std::pmr::memory_resource *TokenStream::get_resource() const {
+	return this->resource;
 }
 
 } // namespace nyan
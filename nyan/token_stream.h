@@ -2,26 +2,55 @@
 #pragma once
 
 
+#include <cstddef>
+#include <deque>
+#include <memory_resource>
 #include <vector>
 
 
 namespace nyan {
 
+class Lexer;
 class Token;
 
 /**
  * Python-yield like iterator for a token stream.
  * You can fetch the next value until nothing is left.
  *
- * The passed container is stored as reference only,
- * so it must be kept owned in the outside.
+ * The tokens either come from a container, or are pulled
+ * from a lexer on demand. The container or lexer is stored
+ * as reference only, so it must be kept owned in the outside.
  */
 class TokenStream {
 public:
 	using tok_t = Token;
 	using container_t = std::vector<tok_t>;
 
-	TokenStream(const container_t &container);
+	/**
+	 * Number of already returned tokens that a streaming
+	 * TokenStream keeps for reinsert_last().
+	 * Tokens returned by next() stay valid for this many further calls.
+	 */
+	static constexpr size_t history_size = 256;
+
+	/**
+	 * Create a stream over the tokens in a container.
+	 *
+	 * @param container Tokens in the stream.
+	 * @param resource Memory resource for the AST created from the stream.
+	 */
+	TokenStream(const container_t &container,
+	            std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+	/**
+	 * Create a stream that pulls the tokens from a lexer when they
+	 * are needed. Only the last few tokens are kept in memory.
+	 *
+	 * @param lexer Lexer that generates the tokens.
+	 * @param resource Memory resource for the AST created from the stream.
+	 */
+	TokenStream(Lexer &lexer,
+	            std::pmr::memory_resource *resource = std::pmr::get_default_resource());
 
 	~TokenStream();
 
@@ -53,16 +82,51 @@ public:
 	 */
 	void reinsert_last();
 
+	/**
+	 * Get the memory resource the AST nodes created
+	 * from this stream allocate their storage from.
+	 *
+	 * @return Memory resource for the AST.
+	 */
+	std::pmr::memory_resource *get_resource() const;
+
 protected:
 	/**
-	 * List of tokens in the stream.
+	 * List of tokens in the stream, nullptr when streaming from a lexer.
 	 */
-	const container_t &container;
+	const container_t *container;
 
 	/**
 	 * Iterator used for advancing/regressing in the stream.
 	 */
 	container_t::const_iterator iter;
+
+	/**
+	 * Lexer the tokens are pulled from, nullptr for a container.
+	 */
+	Lexer *lexer;
+
+	/**
+	 * Tokens pulled from the lexer that may still be requested.
+	 * A deque keeps the returned token pointers stable
+	 * when tokens are added or dropped at the ends.
+	 */
+	std::deque<tok_t> window;
+
+	/**
+	 * Position of the next token in the window.
+	 */
+	size_t window_pos;
+
+	/**
+	 * True if the lexer has produced the end of file token.
+	 */
+	bool lexer_done;
+
+	/**
+	 * Memory resource for the AST nodes.
+	 */
+	std::pmr::memory_resource *resource;
 };
 
 } // namespace nyan
@@ -2,22 +2,80 @@
 
 #include "transaction.h"
 
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+
 #include "c3.h"
+#include "database.h"
 #include "object_state.h"
 #include "state.h"
+#include "util/thread_pool.h"
 #include "view.h"
 
 
 namespace nyan {
 
-// TODO think about parallel transactions:
-// parralel ones in the future don't matter as we'll overwrite them
-// ones that happen before must invalidate this one!
+/**
+ * Views whose target and patch object states are the same
+ * when a patch is added to the transaction.
+ */
+struct patch_group {
+	/**
+	 * Target object state followed by the states of the patch linearization.
+	 */
+	std::vector<const ObjectState *> sources;
+
+	/**
+	 * Views in this group.
+	 */
+	std::vector<view_state *> members;
+
+	/**
+	 * true if the target state was created by this transaction
+	 * and only the views of this group use it.
+	 */
+	bool in_place = false;
+};
+
+
+/**
+ * Get the state a patch for the given object is applied to in a view:
+ * the state this transaction created already, else the view's last state.
+ */
+static const std::shared_ptr<ObjectState> &target_source(const view_state &view_state,
+                                                         symbol_t target,
+                                                         order_t t) {
+	const std::shared_ptr<ObjectState> *changed = view_state.state->get(target);
+	if (changed != nullptr) {
+		return *changed;
+	}
+
+	const std::shared_ptr<ObjectState> &source = view_state.view->get_raw(target, t);
+	if (unlikely(not source)) {
+		throw InternalError{"object copy source not found"};
+	}
+
+	return source;
+}
+
+
+// parallel transactions:
+// ones in the future would be dropped by this one,
+// ones that happen before invalidate this one if they changed what it used.
+// both make the commit fail, so nothing is overwritten silently.
 
 
-Transaction::Transaction(order_t at, std::shared_ptr<View> &&origin) :
+Transaction::Transaction(order_t at, std::shared_ptr<View> &&origin, size_t threads) :
 	valid{true},
-	at{at} {
+	at{at},
+	open{true} {
+	// the views are registered and their children cleaned up.
+	std::unique_lock<std::shared_mutex> lock{origin->database->transaction_mutex};
+
+	this->pool = origin->database->get_transaction_pool(threads);
+
 	auto create_state_mod = [this](std::shared_ptr<View> &&view) {
 		StateHistory &view_history = view->get_state_history();
 
@@ -32,16 +90,20 @@ Transaction::Transaction(order_t at, std::shared_ptr<View> &&origin) :
 		// create a state that follows the current view state.
 		auto new_view_state = std::make_shared<State>(base_view_state);
 
+		size_t first_commit = view->open_transaction();
+
 		this->states.push_back({std::move(view),
 		                        std::move(new_view_state),
-		                        {}});
+		                        {},
+		                        first_commit});
 	};
 
 	// first, perform transaction on the requested view
 	create_state_mod(std::move(origin));
 
 	// this is actually the `origin` view, but we've moved it there.
-	auto &main_view = this->states.at(0).view;
+	// copied, as adding the children's states moves the vector content.
+	std::shared_ptr<View> main_view = this->states.at(0).view;
 
 	// recursively visit all of the view's children and their children
 	// lol C++
@@ -69,7 +131,53 @@ Transaction::Transaction(order_t at, std::shared_ptr<View> &&origin) :
 			}
 		};
 
-	recurse(main_view);
+	try {
+		recurse(main_view);
+	}
+	catch (...) {
+		this->close();
+		throw;
+	}
+}
+
+
+Transaction::Transaction(Transaction &&other) noexcept :
+	error{std::move(other.error)},
+	valid{other.valid},
+	at{other.at},
+	states{std::move(other.states)},
+	read_objects{std::move(other.read_objects)},
+	open{other.open},
+	pool{std::move(other.pool)} {
+	other.open = false;
+}
+
+
+Transaction &Transaction::operator=(Transaction &&other) {
+	if (this != &other) {
+		if (this->open) {
+			std::unique_lock<std::shared_mutex> lock{this->get_mutex()};
+			this->close();
+		}
+
+		this->error = std::move(other.error);
+		this->valid = other.valid;
+		this->at = other.at;
+		this->states = std::move(other.states);
+		this->read_objects = std::move(other.read_objects);
+		this->open = other.open;
+		this->pool = std::move(other.pool);
+		other.open = false;
+	}
+	return *this;
+}
+
+
+Transaction::~Transaction() {
+	if (this->open) {
+		std::unique_lock<std::shared_mutex> lock{this->get_mutex()};
+		this->close();
+	}
 }
 
 
@@ -83,44 +191,174 @@ bool Transaction::add(const Object &patch) {
 		return false;
 	}
 
+	// the view states must not change while they're read.
+	std::shared_lock<std::shared_mutex> lock{this->get_mutex()};
+
 	const auto target_ptr = patch.get_target();
 	// TODO: recheck if target exists?
 	if (target_ptr == nullptr) {
 		throw InternalError{"patch somehow has no target"};
 	}
-	const auto &target = *target_ptr;
 
-	// apply the patch in each view's state
-	for (auto &view_state : this->states) {
-		auto &view = view_state.view;
-		auto &new_state = view_state.state;
-		auto &tracker = view_state.changes;
+	this->apply_patches(*target_ptr, {&patch.get_linearized(this->at)});
 
-		// TODO: speed up the state backtracking for finding the object
+	return true;
+}
 
-		// This does not copy the object if the new state already has it.
-		auto &target_obj = new_state->copy_object(target, this->at, view);
 
-		// apply each patch component (i.e. all the parents of the patch)
-		for (auto &patch_name : patch.get_linearized(this->at)) {
-			auto &patch_tracker = tracker.track_patch(target);
+bool Transaction::add_all(std::span<const Object> patches) {
+	if (unlikely(not this->valid)) {
+		// TODO: throw some error?
+		return false;
+	}
 
-			// apply all patch parents in order (last the patch itself)
-			target_obj->apply(
-				// TODO: use the same mechanism as above to get only parent
-			    //       obj states of base_state
-				view->get_raw(patch_name, this->at),
-				view->get_info(patch_name),
-				patch_tracker);
+	for (auto &patch : patches) {
+		if (unlikely(not patch.is_patch())) {
+			return false;
 		}
 
-		// TODO: linearize here so other patches can depend on that?
+		if (patch.get_target() == nullptr) {
+			throw InternalError{"patch somehow has no target"};
+		}
+	}
+
+	// the view states must not change while they're read.
+	std::shared_lock<std::shared_mutex> lock{this->get_mutex()};
+
+	// linearizations of the patches for each target, in the order the targets
+	// first appear. patches only read states from before the transaction,
+	// so patches for different targets can't affect each other.
+	std::vector<std::pair<const fqon_t *, std::vector<const std::vector<fqon_t> *>>> targets;
+	std::unordered_map<fqon_t, size_t> target_indices;
+
+	for (auto &patch : patches) {
+		const fqon_t &target = *patch.get_target();
+
+		auto ins = target_indices.emplace(target, targets.size());
+		if (ins.second) {
+			targets.push_back({&target, {}});
+		}
+
+		targets[ins.first->second].second.push_back(&patch.get_linearized(this->at));
+	}
+
+	for (auto &[target, patch_lins] : targets) {
+		this->apply_patches(*target, patch_lins);
 	}
 
 	return true;
 }
 
 
+void Transaction::apply_patches(const fqon_t &target,
+                                const std::vector<const std::vector<fqon_t> *> &patch_lins) {
+	auto &main_view = this->states.at(0).view;
+	const symbol_t target_symbol = main_view->get_symbol(target);
+
+	// a commit that changes any of these conflicts with this transaction.
+	this->read_objects.insert(target_symbol);
+
+	size_t component_count = 0;
+	for (auto patch_lin : patch_lins) {
+		component_count += patch_lin->size();
+
+		for (auto &patch_name : *patch_lin) {
+			this->read_objects.insert(main_view->get_symbol(patch_name));
+		}
+	}
+
+	// object states the patches read in each view.
+	std::vector<std::vector<const ObjectState *>> view_sources(this->states.size());
+	this->pool->parallel_for(this->states.size(), [this, &view_sources, &patch_lins, component_count, target_symbol](size_t idx) {
+		const view_state &view_state = this->states[idx];
+		auto &view = view_state.view;
+		auto &sources = view_sources[idx];
+
+		// TODO: speed up the state backtracking for finding the object
+		sources.reserve(component_count + 1);
+		sources.push_back(target_source(view_state, target_symbol, this->at).get());
+		for (auto patch_lin : patch_lins) {
+			for (auto &patch_name : *patch_lin) {
+				// TODO: use the same mechanism as above to get only parent
+				//       obj states of base_state
+				sources.push_back(view->get_raw(patch_name, this->at).get());
+			}
+		}
+	});
+
+	// views that see the same target and patch states get the same result,
+	// so the target is copied and patched only once for each of those groups.
+	std::vector<patch_group> groups;
+	for (size_t idx = 0; idx < this->states.size(); idx++) {
+		auto &sources = view_sources[idx];
+
+		auto group = std::find_if(
+			std::begin(groups),
+			std::end(groups),
+			[&sources](const patch_group &candidate) {
+				return candidate.sources == sources;
+			});
+
+		if (group == std::end(groups)) {
+			groups.push_back({std::move(sources), {}});
+			group = std::prev(std::end(groups));
+		}
+		group->members.push_back(&this->states[idx]);
+	}
+
+	// an object state created by this transaction can be patched in place,
+	// unless views outside of the group use it as well.
+	for (auto &group : groups) {
+		const std::shared_ptr<ObjectState> *changed = group.members.front()->state->get(target_symbol);
+		if (changed == nullptr) {
+			continue;
+		}
+
+		size_t users = std::count_if(
+			std::begin(this->states),
+			std::end(this->states),
+			[target_symbol, changed](const view_state &other) {
+				auto other_obj = other.state->get(target_symbol);
+				return other_obj != nullptr and other_obj->get() == changed->get();
+			});
+
+		group.in_place = (users == group.members.size());
+	}
+
+	// apply the patch once per group
+	this->pool->parallel_for(groups.size(), [this, &groups, &patch_lins, &target, target_symbol](size_t idx) {
+		patch_group &group = groups[idx];
+		view_state &first = *group.members.front();
+		auto &view = first.view;
+
+		const std::shared_ptr<ObjectState> &source = target_source(first, target_symbol, this->at);
+		std::shared_ptr<ObjectState> target_obj = group.in_place ? source : source->copy();
+
+		// apply all patch parents in order (last the patch itself)
+		ObjectChanges changes;
+		for (auto patch_lin : patch_lins) {
+			for (auto &patch_name : *patch_lin) {
+				target_obj->apply(
+					view->get_raw(patch_name, this->at),
+					view->get_info(patch_name),
+					changes);
+			}
+		}
+
+		for (view_state *member : group.members) {
+			member->state->set_object(target_symbol, target_obj);
+
+			auto &patch_tracker = member->changes.track_patch(target);
+			for (auto &parent : changes.get_new_parents()) {
+				patch_tracker.add_parent(parent);
+			}
+		}
+
+		// TODO: linearize here so other patches can depend on that?
+	});
+}
+
+
 bool Transaction::add(const Object & /*patch*/, const Object & /*target*/) {
 	// TODO check if the target is a child of the original target
 	throw InternalError{"TODO custom patch target"};
@@ -133,21 +371,58 @@ bool Transaction::commit() {
 		return false;
 	}
 
-	// TODO check if no other transaction was before this one.
-
-
-	// merge a new state with an already existing base state
-	// this must be done for a transaction at a time
-	// where data is already stored.
-	this->merge_changed_states();
+	// objects to notify about in each view.
+	std::vector<std::unordered_set<fqon_t>> affected;
+
+	{
+		std::unique_lock<std::shared_mutex> lock{this->get_mutex()};
+
+		// transactions committed since this one was created
+		// may have changed what this one is based on.
+		if (this->check_conflicts()) {
+			// merge a new state with an already existing base state
+			// this must be done for a transaction at a time
+			// where data is already stored.
+			this->merge_changed_states();
+
+			// for each view: those updates have to be performed
+			std::vector<view_update> updates = this->generate_updates();
+
+			// now, all sanity checks are done and we can update the view!
+			// a failed update generation aborts the transaction.
+			if (this->valid) {
+				// remember the changes for the transactions that are still open.
+				for (size_t idx = 0; idx < this->states.size(); idx++) {
+					std::unordered_set<symbol_t> changed;
+					auto &view = this->states[idx].view;
+
+					for (auto &it : this->states[idx].changes.get_object_changes()) {
+						changed.insert(view->get_symbol(it.first));
+					}
+					for (auto &lin : updates[idx].linearizations) {
+						changed.insert(view->get_symbol(lin.at(0)));
+					}
+
+					view->record_commit(this->at, std::move(changed));
+				}
 
-	// for each view: those updates have to be performed
-	std::vector<view_update> updates = this->generate_updates();
+				affected = this->update_views(std::move(updates));
+			}
+		}
 
-	// now, all sanity checks are done and we can update the view!
-	this->update_views(std::move(updates));
+		this->close();
+	}
 
-	// TODO mark value caches dirty
+	// now that the views were updated, we can fire the event notifications.
+	// the lock is released, so the callbacks can use transactions.
+	for (size_t idx = 0; idx < affected.size(); idx++) {
+		// TODO: if we don't want to fire for every object, but only
+		//       for those with some members changed, we have to
+		//       extend the ChangeTracker and track individual member updates
+		//       (maybe only if the object is of interest).
+		//       then we pass only the relevant objects here.
+		this->states[idx].view->fire_notifications(affected[idx], this->at);
+	}
 
 	bool ret = this->valid;
 	this->valid = false;
@@ -155,8 +430,30 @@ bool Transaction::commit() {
 }
 
 
-void Transaction::merge_changed_states() {
+bool Transaction::check_conflicts() {
 	for (auto &view_state : this->states) {
+		const commit_record *conflict = view_state.view->find_conflict(
+			view_state.first_commit,
+			this->at,
+			this->read_objects);
+
+		if (conflict != nullptr) {
+			std::ostringstream builder;
+			builder << "transaction at t=" << this->at
+			        << " conflicts with a transaction committed for t=" << conflict->at
+			        << " in the meantime";
+			this->set_error(std::make_exception_ptr(ConflictError{builder.str()}));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+void Transaction::merge_changed_states() {
+	this->pool->parallel_for(this->states.size(), [this](size_t idx) {
+		auto &view_state = this->states[idx];
 		auto &view = view_state.view;
 
 		StateHistory &view_history = view->get_state_history();
@@ -182,49 +479,65 @@ void Transaction::merge_changed_states() {
 			// so we now have a combined new state
 			view_state.state = std::move(merge_base);
 		}
-	}
+	});
 }
 
 
 std::vector<view_update> Transaction::generate_updates() {
-	std::vector<view_update> updates;
+	std::vector<view_update> updates(this->states.size());
+
+	// errors of each view, reported in view order below.
+	std::vector<std::exception_ptr> errors(this->states.size());
 
 	// try linearizing objects which have changed parents
 	// and their children
-	for (auto &view_state : this->states) {
+	this->pool->parallel_for(this->states.size(), [this, &updates, &errors](size_t idx) {
+		auto &view_state = this->states[idx];
 		auto &view = view_state.view;
 		auto &new_state = view_state.state;
 		auto &tracker = view_state.changes;
 
 		// update to perform for this view.
-		view_update update;
+		view_update &update = updates[idx];
 
-		// from the known parent changes, find all affected children
-		// affected are: children of those objects which the child cache knows.
+		try {
+			// from the known parent changes, find all affected children
+			// affected are: children of those objects which the child cache knows.
 
-		// contains all objects whose parents changed.
-		std::unordered_set<fqon_t> objs_to_linearize;
+			// contains all objects whose parents changed.
+			std::unordered_set<fqon_t> objs_to_linearize;
 
-		// take a look at all the needed inheritance updates
-		// and generate the child tracking update from it.
-		update.children = this->inheritance_updates(
-			tracker,
-			view,
-			objs_to_linearize);
+			// take a look at all the needed inheritance updates
+			// and generate the child tracking update from it.
+			update.children = this->inheritance_updates(
+				tracker,
+				view,
+				objs_to_linearize);
 
-		try {
 			update.linearizations = this->relinearize_objects(
 				objs_to_linearize,
 				view,
 				new_state);
 		}
+		catch (...) {
+			errors[idx] = std::current_exception();
+		}
+	});
+
+	for (size_t idx = 0; idx < errors.size(); idx++) {
+		if (not errors[idx]) {
+			continue;
+		}
+
+		try {
+			std::rethrow_exception(errors[idx]);
+		}
 		catch (C3Error &) {
 			// this error is non-fatal but aborts the transaction
 			this->set_error(std::current_exception());
+			updates.resize(idx);
 			break;
 		}
-
-		updates.push_back(std::move(update));
 	}
 
 	return updates;
@@ -280,14 +593,16 @@ Transaction::relinearize_objects(const std::unordered_set<fqon_t> &objs_to_linea
 		auto lin = linearize(
 			obj,
 			[this, &view, &new_state](const fqon_t &name) -> const ObjectState & {
+				symbol_t obj = view->get_symbol(name);
+
 				// try to use the object in the new state if it's in there
-				const auto &new_obj_state = new_state->get(name);
+				const auto &new_obj_state = new_state->get(obj);
 				if (new_obj_state != nullptr) {
 					return *new_obj_state->get();
 				}
 
 				// else, get it from the already existing view.
-				const ObjectState *view_obj_state = view->get_raw(name, this->at).get();
+				const ObjectState *view_obj_state = view->get_raw(obj, this->at).get();
 				if (unlikely(view_obj_state == nullptr)) {
 					throw InternalError{"could not find parent object"};
 				}
@@ -301,9 +616,9 @@ Transaction::relinearize_objects(const std::unordered_set<fqon_t> &objs_to_linea
 }
 
 
-void Transaction::update_views(std::vector<view_update> &&updates) {
-	size_t idx = 0;
-	for (auto &view_state : this->states) {
+std::vector<std::unordered_set<fqon_t>> Transaction::update_views(std::vector<view_update> &&updates) {
+	this->pool->parallel_for(this->states.size(), [this, &updates](size_t idx) {
+		auto &view_state = this->states[idx];
 		auto &view = view_state.view;
 		auto &new_state = view_state.state;
 
@@ -314,8 +629,18 @@ void Transaction::update_views(std::vector<view_update> &&updates) {
 		view_history.insert(std::move(new_state), this->at);
 
 		// insert all newly calculated linearizations.
+		// the new state is in the history already,
+		// so the lineage sees the members of the new states.
 		for (auto &lin : updates[idx].linearizations) {
-			view_history.insert_linearization(std::move(lin), this->at);
+			symbol_t obj = view->get_symbol(lin.at(0));
+			Lineage lineage{
+				lin,
+				view->get_database().get_info(),
+				[this, &view](symbol_t parent) -> const ObjectState & {
+					return *view->get_raw(parent, this->at);
+				}};
+
+			view_history.insert_linearization(obj, std::move(lin), std::move(lineage), this->at);
 		}
 
 		// inheritance updates can generate new children for existing objects
@@ -328,14 +653,19 @@ void Transaction::update_views(std::vector<view_update> &&updates) {
 			new_children.insert(std::begin(previous_children),
 			                    std::end(previous_children));
 
-			view_history.insert_children(obj, std::move(new_children), this->at);
+			view_history.insert_children(view->get_symbol(obj),
+			                             std::move(new_children),
+			                             this->at,
+			                             view->get_database().get_info());
 		}
+	});
 
-		idx += 1;
-	}
+	// all objects which were changed or whose parents were changed.
+	// computed after the update so the new children are known.
+	std::vector<std::unordered_set<fqon_t>> affected(this->states.size());
 
-	// now that the views were updated, we can fire the event notifications.
-	for (auto &view_state : this->states) {
+	this->pool->parallel_for(this->states.size(), [this, &affected](size_t idx) {
+		auto &view_state = this->states[idx];
 		auto &view = view_state.view;
 		auto &tracker = view_state.changes;
 
@@ -343,19 +673,25 @@ void Transaction::update_views(std::vector<view_update> &&updates) {
 		std::unordered_set<fqon_t> affected_children;
 		// all children of the patched objects are also affected.
 		for (auto &obj : updated_objects) {
-			std::unordered_set<fqon_t> children = view->get_obj_children_all(obj, this->at);
-			affected_children.merge(children);
+			const auto &children = view->get_obj_children_all(obj, this->at);
+			affected_children.insert(std::begin(children), std::end(children));
 		}
 
 		updated_objects.merge(affected_children);
 
-		// TODO: if we don't want to fire for every object, but only
-		//       for those with some members changed, we have to
-		//       extend the ChangeTracker and track individual member updates
-		//       (maybe only if the object is of interest).
-		//       then we pass only the relevant objects here.
-		view->fire_notifications(updated_objects, this->at);
-	}
+		// values calculated from the old state are outdated now.
+		// this must happen in all views before any callback can query values.
+		view->invalidate_values(updated_objects, this->at);
+
+		affected[idx] = std::move(updated_objects);
+	});
+
+	return affected;
+}
+
+
+const std::exception_ptr &Transaction::get_exception() const {
+	return this->error;
 }
 
 
@@ -364,4 +700,17 @@ void Transaction::set_error(std::exception_ptr &&exc) {
 	this->error = std::move(exc);
 }
 
+
+void Transaction::close() {
+	for (auto &view_state : this->states) {
+		view_state.view->close_transaction(view_state.first_commit);
+	}
+	this->open = false;
+}
+
+
+std::shared_mutex &Transaction::get_mutex() const {
+	return this->states.at(0).view->database->transaction_mutex;
+}
+
 } // namespace nyan
@@ -3,6 +3,8 @@
 
 #include <exception>
 #include <memory>
+#include <shared_mutex>
+#include <span>
 #include <string>
 #include <tuple>
 #include <unordered_map>
@@ -19,6 +21,10 @@ class Object;
 class State;
 class View;
 
+namespace util {
+class ThreadPool;
+} // namespace util
+
 
 /**
  * Information to update for a view.
@@ -58,15 +64,69 @@ struct view_state {
 	 * Changes done in the transaction to invalidate caches.
 	 */
 	ChangeTracker changes;
+
+	/**
+	 * Number of transactions committed in the view when this one
+	 * was created. Those committed later may conflict with this one.
+	 */
+	size_t first_commit;
+};
+
+
+/**
+ * Objects a committed transaction changed in a view.
+ */
+struct commit_record {
+	/**
+	 * Number of transactions committed in the view before this one.
+	 */
+	size_t id;
+
+	/**
+	 * Time the transaction was committed for.
+	 */
+	order_t at;
+
+	/**
+	 * Symbols of the objects whose states or linearizations changed.
+	 */
+	std::unordered_set<symbol_t> changed;
 };
 
 
 /**
  * Patch transaction
+ *
+ * Different transactions can be created and filled in multiple threads
+ * at once, and those threads may query the views meanwhile. A single
+ * transaction must only be used by one thread at a time.
+ * Transactions are committed one at a time, and a commit fails with a ConflictError
+ * if a transaction committed after this one was created is for a later time,
+ * or changed an object this one used at the same or an earlier time.
  */
 class Transaction {
 public:
-	Transaction(order_t at, std::shared_ptr<View> &&origin);
+	/**
+	 * Create a transaction for a view and all its child views.
+	 *
+	 * @param at Time at which the transaction is applied.
+	 * @param origin View the transaction is applied to.
+	 * @param threads Number of threads that apply the patches and
+	 *     compute the updates of the views. Views are processed in parallel,
+	 *     so this only helps if the view has child views.
+	 *     The workers are shared with other transactions of the database.
+	 */
+	Transaction(order_t at, std::shared_ptr<View> &&origin, size_t threads = 1);
+
+	// moving hands over the registration in the views.
+	Transaction(Transaction &&other) noexcept;
+
+	// an open transaction is closed first, which locks the database.
+	Transaction &operator=(Transaction &&other);
+	Transaction(const Transaction &other) = delete;
+	Transaction &operator=(const Transaction &other) = delete;
+
+	~Transaction();
 
 	/**
 	 * Add a patch to the transaction. Apply the patch to the target
@@ -78,6 +138,18 @@ public:
 	 */
 	bool add(const Object &obj);
 
+	/**
+	 * Add patches to the transaction, with the same result as calling
+	 * add() for each of them. The patches are grouped by their target,
+	 * so each target is patched in one pass.
+	 * Nothing is applied if one of the objects is not a patch.
+	 *
+	 * @param patches Patches to be applied, in order.
+	 *
+	 * @return true if the patches are successfully applied, else false.
+	 */
+	bool add_all(std::span<const Object> patches);
+
 	/**
 	 * Add a patch to the transaction. Apply the patch to a custom target,
 	 * which must be a descendant of the target stored in the patch.
@@ -91,6 +163,8 @@ public:
 
 	/**
 	 * Commit the transaction, i.e. update the views.
+	 * Fails if it conflicts with a transaction committed since this one
+	 * was created, see get_exception().
 	 *
 	 * @return true if the transaction was successful, else false.
 	 */
@@ -104,6 +178,23 @@ public:
 	const std::exception_ptr &get_exception() const;
 
 protected:
+	/**
+	 * Apply patches to a target in each view's state.
+	 *
+	 * @param target Identifier of the patched object.
+	 * @param patch_lins Linearizations of the patches to apply, in order.
+	 */
+	void apply_patches(const fqon_t &target,
+	                   const std::vector<const std::vector<fqon_t> *> &patch_lins);
+
+	/**
+	 * Check if a transaction committed since this one was created
+	 * conflicts with this one. Sets the error if so.
+	 *
+	 * @return true if the transaction can be committed, else false.
+	 */
+	bool check_conflicts();
+
 	/**
 	 * Merge the new states with an existing one from the view.
 	 */
@@ -154,8 +245,25 @@ protected:
 	 * The update list is destroyed.
 	 *
 	 * @param updates List of updates for the views.
+	 *
+	 * @return Objects that changed or whose parents changed in each view,
+	 *     their notifications still have to be fired.
+	 */
+	std::vector<std::unordered_set<fqon_t>> update_views(std::vector<view_update> &&updates);
+
+	/**
+	 * Deregister the transaction from its views, so they forget
+	 * the commits only this transaction could conflict with.
+	 * The transaction lock must be held.
 	 */
-	void update_views(std::vector<view_update> &&updates);
+	void close();
+
+	/**
+	 * Get the lock of the database that orders the transactions.
+	 *
+	 * @return Transaction lock of the views' database.
+	 */
+	std::shared_mutex &get_mutex() const;
 
 	/**
 	 * Set the transaction to invalid and store the error. This can
@@ -185,6 +293,23 @@ protected:
 	 * The views to which the transaction will be applied in.
 	 */
 	std::vector<view_state> states;
+
+	/**
+	 * Symbols of the objects the patches used. If another transaction
+	 * changes them before this one is committed, the commit fails.
+	 */
+	std::unordered_set<symbol_t> read_objects;
+
+	/**
+	 * True while the transaction is registered in its views.
+	 */
+	bool open;
+
+	/**
+	 * Workers that process the views in parallel, owned by the database.
+	 * Without workers, the views are processed in the calling thread.
+	 */
+	std::shared_ptr<util::ThreadPool> pool;
 };
 
 } // namespace nyan
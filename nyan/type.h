@@ -61,6 +61,14 @@ public:
 	     const Namespace &ns,
 	     const MetaInfo &type_info);
 
+protected:
+	friend class Snapshot;
+
+	/**
+	 * Construct an empty type, filled when restoring a Snapshot.
+	 */
+	Type() = default;
+
 public:
 	virtual ~Type() = default;
 
@@ -0,0 +1,88 @@
+// Copyright 2026-2026 the nyan authors, LGPLv3+. See copying.md for legal info.
+
+#include "thread_pool.h"
+
+#include <algorithm>
+
+
+namespace nyan::util {
+
+ThreadPool::ThreadPool(size_t thread_count) {
+	this->workers.reserve(thread_count);
+	for (size_t i = 0; i < thread_count; i++) {
+		this->workers.emplace_back(&ThreadPool::work, this);
+	}
+}
+
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock{this->mutex};
+		this->stop = true;
+	}
+	this->task_available.notify_all();
+
+	for (auto &worker : this->workers) {
+		worker.join();
+	}
+}
+
+
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)> &func) {
+	// some chunks per worker balance the different costs of the indices.
+	size_t chunk_count = std::min(count, std::max<size_t>(this->size() * 4, 1));
+
+	std::vector<std::future<void>> chunks;
+	chunks.reserve(chunk_count);
+
+	for (size_t chunk = 0; chunk < chunk_count; chunk++) {
+		size_t begin = count * chunk / chunk_count;
+		size_t end = count * (chunk + 1) / chunk_count;
+
+		chunks.push_back(this->submit([&func, begin, end]() {
+			for (size_t idx = begin; idx < end; idx++) {
+				func(idx);
+			}
+		}));
+	}
+
+	// the chunks reference the caller's data,
+	// so all of them must be done before an error is thrown.
+	for (auto &chunk : chunks) {
+		chunk.wait();
+	}
+
+	for (auto &chunk : chunks) {
+		chunk.get();
+	}
+}
+
+
+size_t ThreadPool::size() const {
+	return this->workers.size();
+}
+
+
+void ThreadPool::work() {
+	while (true) {
+		std::function<void()> task;
+
+		{
+			std::unique_lock<std::mutex> lock{this->mutex};
+			this->task_available.wait(lock, [this]() {
+				return this->stop or not this->tasks.empty();
+			});
+
+			if (this->stop) {
+				return;
+			}
+
+			task = std::move(this->tasks.front());
+			this->tasks.pop();
+		}
+
+		task();
+	}
+}
+
+} // namespace nyan::util
@@ -0,0 +1,128 @@
+// Copyright 2026-2026 the nyan authors, LGPLv3+. See copying.md for legal info.
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace nyan::util {
+
+/**
+ * Fixed set of worker threads that process submitted tasks in FIFO order.
+ *
+ * Example:
+ *   ThreadPool pool{4};
+ *   std::future<int> result = pool.submit([]() { return 42; });
+ *   result.get() == 42;
+ *
+ * A pool without workers runs each task directly in the submitting thread.
+ * Tasks that did not start when the pool is destroyed are discarded,
+ * waiting on their futures then throws std::future_error.
+ */
+class ThreadPool {
+public:
+	/**
+	 * Create the pool and start the workers.
+	 *
+	 * @param thread_count Number of worker threads.
+	 */
+	explicit ThreadPool(size_t thread_count);
+
+	/**
+	 * Finish the running tasks and join the workers.
+	 */
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	/**
+	 * Enqueue a task.
+	 * Exceptions thrown by the task are stored in the returned future.
+	 *
+	 * @param func Callable without arguments.
+	 *
+	 * @return Future to retrieve the result of the task.
+	 */
+	template <typename F>
+	std::future<std::invoke_result_t<F>> submit(F &&func) {
+		using result_t = std::invoke_result_t<F>;
+
+		auto task = std::make_shared<std::packaged_task<result_t()>>(std::forward<F>(func));
+		std::future<result_t> ret = task->get_future();
+
+		if (this->workers.empty()) {
+			(*task)();
+			return ret;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock{this->mutex};
+			this->tasks.emplace([task]() { (*task)(); });
+		}
+		this->task_available.notify_one();
+
+		return ret;
+	}
+
+	/**
+	 * Call a function for each index in [0, count) in the pool
+	 * and wait until all calls are done.
+	 * The indices are split into contiguous chunks, and each chunk stops at
+	 * its first error. The error with the lowest index is rethrown, so it is
+	 * the same error that a serial loop would throw.
+	 *
+	 * @param count Number of indices.
+	 * @param func Function called with each index.
+	 */
+	void parallel_for(size_t count, const std::function<void(size_t)> &func);
+
+	/**
+	 * Get the number of worker threads.
+	 *
+	 * @return Number of workers, 0 if tasks run in the submitting thread.
+	 */
+	size_t size() const;
+
+protected:
+	/**
+	 * Main loop of a worker thread.
+	 */
+	void work();
+
+	/**
+	 * Worker threads.
+	 */
+	std::vector<std::thread> workers;
+
+	/**
+	 * Tasks that wait for a free worker.
+	 */
+	std::queue<std::function<void()>> tasks;
+
+	/**
+	 * Protects the task queue and the stop flag.
+	 */
+	std::mutex mutex;
+
+	/**
+	 * Signals that a task was enqueued or the pool is stopping.
+	 */
+	std::condition_variable task_available;
+
+	/**
+	 * Set when the pool is destroyed.
+	 */
+	bool stop = false;
+};
+
+} // namespace nyan::util
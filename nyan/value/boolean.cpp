@@ -23,7 +23,7 @@ Boolean::Boolean(const IDToken &token) {
 			"invalid value for boolean"};
 	}
 
-	const std::string &token_value = token.get_first();
+	std::string_view token_value = token.get_first();
 
 	if (token_value == "True") {
 		this->value = true;
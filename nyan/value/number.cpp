@@ -54,7 +54,7 @@ Int::Number(const IDToken &token) {
 			}
 		}
 		else {
-			this->value = std::stoll(token.get_first(), nullptr, 0);
+			this->value = std::stoll(std::string{token.get_first()}, nullptr, 0);
 		}
 	}
 	catch (std::invalid_argument &) {
@@ -85,7 +85,7 @@ Float::Number(const IDToken &token) {
 			}
 		}
 		else {
-			this->value = std::stod(token.get_first());
+			this->value = std::stod(std::string{token.get_first()});
 		}
 	}
 	catch (std::invalid_argument &) {
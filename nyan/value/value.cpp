@@ -153,7 +153,7 @@ static std::vector<ValueHolder> value_from_value_token(
  * @param astvalues Value tokens of a member defiinition.
  * @return true if the value is 'None', false otherwise.
  */
-static bool check_container_none(const std::vector<ValueToken> &astvalues) {
+static bool check_container_none(const std::pmr::vector<ValueToken> &astvalues) {
 	if (astvalues.size() == 1) {
 		auto &id_tokens = astvalues[0].get_value();
 		if (id_tokens.size() == 1) {
@@ -177,7 +177,7 @@ ValueHolder Value::from_ast(
 
 	ValueHolder value;
 
-	const std::vector<ValueToken> &astvalues = astmembervalue.get_values();
+	const auto &astvalues = astmembervalue.get_values();
 
 	// single value; not a set, dict, ...
 	if (not target_type.is_container()) {
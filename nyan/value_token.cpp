@@ -11,15 +11,17 @@
 namespace nyan {
 
 
-ValueToken::ValueToken(const IDToken &token) :
-	container_type{composite_t::SINGLE} {
-	this->tokens.push_back(token);
+ValueToken::ValueToken(const IDToken &token,
+                       std::pmr::memory_resource *resource) :
+	container_type{composite_t::SINGLE},
+	tokens{resource} {
+	this->tokens.emplace_back(token, resource);
 }
 
 
 ValueToken::ValueToken(composite_t type,
-                       std::vector<IDToken> &tokens) :
-	tokens{tokens} {
+                       std::pmr::vector<IDToken> &&tokens) :
+	tokens{std::move(tokens)} {
 	const static std::unordered_set<composite_t> container_types{
 		composite_t::SET,
 		composite_t::ORDEREDSET,
@@ -54,7 +56,7 @@ bool ValueToken::exists() const {
 }
 
 
-const Location &ValueToken::get_start_location() const {
+Location ValueToken::get_start_location() const {
 	if (unlikely(not this->exists())) {
 		throw InternalError{"this ValueToken doesn't exist, but you queried its location"};
 	}
@@ -84,7 +86,7 @@ size_t ValueToken::get_length() const {
 }
 
 
-const std::vector<IDToken> &ValueToken::get_value() const {
+const std::pmr::vector<IDToken> &ValueToken::get_value() const {
 	return this->tokens;
 }
 
@@ -2,6 +2,7 @@
 #pragma once
 
 
+#include <memory_resource>
 #include <string>
 #include <vector>
 
@@ -21,14 +22,16 @@ public:
 
 	/**
 	 * Simple constructor for a single value that is not in a container.
+	 * The token is copied into the given memory resource.
 	 */
-	ValueToken(const IDToken &token);
+	ValueToken(const IDToken &token,
+	           std::pmr::memory_resource *resource = std::pmr::get_default_resource());
 
 	/**
 	 * Constructor for value tokens in a container.
 	 */
 	ValueToken(composite_t type,
-	           std::vector<IDToken> &tokens);
+	           std::pmr::vector<IDToken> &&tokens);
 
 	/**
 	 * Get the string representation of this ValueToken.
@@ -49,7 +52,7 @@ public:
 	 *
 	 * @return Location of this ValueToken.
 	 */
-	const Location &get_start_location() const;
+	Location get_start_location() const;
 
 	/**
 	 * Get the character length of this ValueToken.
@@ -63,7 +66,7 @@ public:
 	 *
 	 * @return List of IDTokens in this ValueToken.
 	 */
-	const std::vector<IDToken> &get_value() const;
+	const std::pmr::vector<IDToken> &get_value() const;
 
 protected:
 	/**
@@ -81,7 +84,7 @@ protected:
 	/**
 	 * Components in the token.
 	 */
-	std::vector<IDToken> tokens;
+	std::pmr::vector<IDToken> tokens;
 };
 
 
@@ -2,11 +2,14 @@
 
 #include "view.h"
 
+#include <algorithm>
+
 #include "c3.h"
 #include "database.h"
 #include "object_notifier.h"
 #include "object_state.h"
 #include "state.h"
+#include "value/value.h"
 
 
 namespace nyan {
@@ -18,28 +21,139 @@ View::View(const std::shared_ptr<Database> &database) :
 
 
 Object View::get_object(const fqon_t &fqon) {
-	// test for object existence
-	this->get_info(fqon);
-
-	// TODO: store info in object to avoid further lookups.
+	// the object handle looks up the object symbol,
+	// which also tests for object existence.
 	return Object{fqon, shared_from_this()};
 }
 
 const std::shared_ptr<Object> View::get_object_ptr(const fqon_t &fqon) {
-	// test for object existence
-	this->get_info(fqon);
-
 	return std::make_shared<Object>(Object::Restricted{}, fqon, shared_from_this());
 }
 
 
+std::vector<ValueHolder> View::get_values(std::span<const fqon_t> objects,
+                                          const memberid_t &member,
+                                          order_t t) {
+	std::vector<ValueHolder> ret;
+	if (objects.empty()) {
+		return ret;
+	}
+	ret.reserve(objects.size());
+
+	const symbol_t *member_symbol = this->database->get_info().get_member_symbols().find(member);
+	if (unlikely(member_symbol == nullptr)) {
+		// no object has a member with this name.
+		throw MemberNotFoundError{objects.front(), member};
+	}
+
+	// shared by all objects of the batch
+	std::unordered_map<symbol_t, std::optional<ValueHolder>> calculated;
+	calculated.reserve(objects.size());
+
+	for (auto &obj : objects) {
+		std::optional<ValueHolder> value = this->calculate_shared_value(
+			this->get_symbol(obj),
+			*member_symbol,
+			t,
+			&calculated);
+
+		if (unlikely(not value.has_value())) {
+			throw MemberNotFoundError{obj, member};
+		}
+
+		// the value is shared with other objects and the cache,
+		// the caller gets its own.
+		ret.push_back((*value)->copy());
+	}
+
+	return ret;
+}
+
+
+std::optional<ValueHolder> View::calculate_shared_value(symbol_t obj,
+                                                        symbol_t member,
+                                                        order_t t,
+                                                        std::unordered_map<symbol_t, std::optional<ValueHolder>> *calculated) {
+	auto known = calculated->find(obj);
+	if (known != calculated->end()) {
+		return known->second;
+	}
+
+	// values from the view cache will be found there again,
+	// they don't need to be remembered in the batch.
+	std::optional<ValueHolder> cached = this->get_cached_value(obj, member, t);
+	if (cached.has_value()) {
+		return cached;
+	}
+
+	const std::vector<fqon_t> &linearization = this->get_linearization(obj, t);
+
+	// states of the objects in front of the base value
+	std::vector<std::shared_ptr<ObjectState>> states;
+
+	// find the base value: either the value of an ancestor that
+	// continues with the same linearization, or the first value assigned with =
+	std::optional<ValueHolder> result;
+	bool is_copy = false;
+	size_t base_idx = 0;
+	for (; base_idx < linearization.size(); base_idx++) {
+		symbol_t current = this->get_symbol(linearization[base_idx]);
+
+		if (base_idx > 0) {
+			const std::vector<fqon_t> &current_lin = this->get_linearization(current, t);
+			if (std::equal(linearization.begin() + base_idx, linearization.end(),
+			               current_lin.begin(), current_lin.end())) {
+				result = this->calculate_shared_value(current, member, t, calculated);
+				break;
+			}
+		}
+
+		states.push_back(this->get_raw(current, t));
+		const Member *obj_member = states.back()->get(member);
+		if (obj_member != nullptr and obj_member->get_operation() == nyan_op::ASSIGN) {
+			result = obj_member->get_value().copy();
+			is_copy = true;
+			break;
+		}
+	}
+
+	if (result.has_value()) {
+		// apply the changes in front of the base value,
+		// skipping the object that assigns it.
+		for (size_t idx = base_idx; idx-- > 0;) {
+			const Member *change = states[idx]->get(member);
+			if (change == nullptr) {
+				continue;
+			}
+
+			// the ancestor value is shared, so only modify a copy.
+			if (not is_copy) {
+				result = (*result)->copy();
+				is_copy = true;
+			}
+			(*result)->apply(*change);
+		}
+
+		this->cache_value(obj, member, t, *result);
+	}
+
+	calculated->emplace(obj, result);
+	return result;
+}
+
+
 const std::shared_ptr<ObjectState> &View::get_raw(const fqon_t &fqon, order_t t) const {
-	auto state = this->state.get_obj_state(fqon, t);
+	return this->get_raw(this->get_symbol(fqon), t);
+}
+
+
+const std::shared_ptr<ObjectState> &View::get_raw(symbol_t obj, order_t t) const {
+	auto state = this->state.get_obj_state(obj, t);
 	if (state == nullptr) {
 		auto &dbstate = this->database->get_state();
-		auto db_obj_state = dbstate->get(fqon);
-		if (db_obj_state == nullptr) {
-			throw ObjectNotFoundError{fqon};
+		auto db_obj_state = dbstate->get(obj);
+		if (unlikely(db_obj_state == nullptr)) {
+			throw InternalError{"object symbol not in database state"};
 		}
 
 		return *db_obj_state;
@@ -50,6 +164,16 @@ const std::shared_ptr<ObjectState> &View::get_raw(const fqon_t &fqon, order_t t)
 }
 
 
+symbol_t View::get_symbol(const fqon_t &fqon) const {
+	const symbol_t *symbol = this->database->get_info().get_object_symbol(fqon);
+	if (unlikely(symbol == nullptr)) {
+		throw ObjectNotFoundError{fqon};
+	}
+
+	return *symbol;
+}
+
+
 const ObjectInfo &View::get_info(const fqon_t &fqon) const {
 	const ObjectInfo *info = this->database->get_info().get_object(fqon);
 	if (unlikely(info == nullptr)) {
@@ -60,18 +184,45 @@ const ObjectInfo &View::get_info(const fqon_t &fqon) const {
 }
 
 
-Transaction View::new_transaction(order_t t) {
-	return Transaction{t, shared_from_this()};
+Transaction View::new_transaction(order_t t, size_t threads) {
+	if (unlikely(this->frozen)) {
+		throw APIError{"can't create a transaction for a view snapshot"};
+	}
+
+	return Transaction{t, shared_from_this(), threads};
 }
 
 
 std::shared_ptr<View> View::new_child() {
+	if (unlikely(this->frozen)) {
+		throw APIError{"can't create a child of a view snapshot"};
+	}
+
 	auto ret = std::make_shared<View>(this->database);
 	this->add_child(ret);
 	return ret;
 }
 
 
+std::shared_ptr<View> View::snapshot(order_t t) {
+	// commits must not change the history while it is copied.
+	std::shared_lock<std::shared_mutex> lock{this->database->transaction_mutex};
+
+	auto ret = std::make_shared<View>(this->database);
+	ret->state.copy_at(this->state, t);
+	ret->state.freeze();
+	ret->snapshot_descendants = std::vector<snapshot_descendants_t>(
+		this->database->get_info().get_objects().size());
+	ret->frozen = true;
+	return ret;
+}
+
+
+bool View::is_snapshot() const {
+	return this->frozen;
+}
+
+
 void View::cleanup_stale_children() {
 	auto it = std::begin(this->children);
 
@@ -103,34 +254,76 @@ const Database &View::get_database() const {
 
 
 const std::vector<fqon_t> &View::get_linearization(const fqon_t &fqon, order_t t) const {
-	return this->state.get_linearization(fqon, t, this->get_database().get_info());
+	return this->get_linearization(this->get_symbol(fqon), t);
+}
+
+
+const std::vector<fqon_t> &View::get_linearization(symbol_t obj, order_t t) const {
+	return this->state.get_linearization(obj, t, this->get_database().get_info());
+}
+
+
+const Lineage &View::get_lineage(symbol_t obj, order_t t) const {
+	return this->state.get_lineage(obj, t, this->get_database().get_info());
 }
 
 
 const std::unordered_set<fqon_t> &View::get_obj_children(const fqon_t &fqon, order_t t) const {
-	return this->state.get_children(fqon, t, this->get_database().get_info());
+	return this->get_obj_children(this->get_symbol(fqon), t);
 }
 
 
-std::unordered_set<fqon_t> View::get_obj_children_all(const fqon_t &fqon, order_t t) const {
-	std::unordered_set<fqon_t> ret;
+const std::unordered_set<fqon_t> &View::get_obj_children(symbol_t obj, order_t t) const {
+	return this->state.get_children(obj, t, this->get_database().get_info());
+}
 
-	this->gather_obj_children(ret, fqon, t);
 
-	return ret;
+const std::unordered_set<fqon_t> &View::get_obj_children_all(const fqon_t &fqon, order_t t) {
+	return this->get_obj_children_all(this->get_symbol(fqon), t);
+}
+
+
+const std::unordered_set<fqon_t> &View::get_obj_children_all(symbol_t obj, order_t t) {
+	if (this->frozen) {
+		if (unlikely(obj >= this->snapshot_descendants.size())) {
+			throw APIError{"object was loaded after the view snapshot was taken"};
+		}
+
+		// the snapshot content is the same for all times.
+		snapshot_descendants_t &entry = this->snapshot_descendants[obj];
+		std::call_once(entry.gathered, [&] {
+			this->gather_obj_children(entry.descendants, obj, t);
+		});
+		return entry.descendants;
+	}
+
+	const std::unordered_set<fqon_t> *cached = this->state.get_descendants(obj, t);
+	if (cached != nullptr) {
+		return *cached;
+	}
+
+	std::unordered_set<fqon_t> ret;
+	this->gather_obj_children(ret, obj, t);
+
+	return this->state.insert_descendants(obj, t, std::move(ret));
 }
 
 
 std::shared_ptr<ObjectNotifier> View::create_notifier(const fqon_t &fqon,
                                                       const update_cb_t &callback) {
-	auto it = this->notifiers.find(fqon);
+	if (unlikely(this->frozen)) {
+		throw APIError{"can't notify about changes of a view snapshot"};
+	}
+
+	symbol_t obj = this->get_symbol(fqon);
+	auto it = this->notifiers.find(obj);
 	decltype(this->notifiers)::mapped_type *notifier_set = nullptr;
 
 	if (it == std::end(this->notifiers)) {
 		// create new set, add to object map and and get pointer
 		auto ins = this->notifiers.insert(
 			{
-				fqon,
+				obj,
 				std::unordered_set<std::shared_ptr<ObjectNotifierHandle>>{},
 			});
 
@@ -149,7 +342,7 @@ std::shared_ptr<ObjectNotifier> View::create_notifier(const fqon_t &fqon,
 
 void View::deregister_notifier(const fqon_t &fqon,
                                const std::shared_ptr<ObjectNotifierHandle> &notifier) {
-	auto it = this->notifiers.find(fqon);
+	auto it = this->notifiers.find(this->get_symbol(fqon));
 	if (it != std::end(this->notifiers)) {
 		size_t removed = it->second.erase(notifier);
 		if (removed == 0) {
@@ -165,10 +358,11 @@ void View::deregister_notifier(const fqon_t &fqon,
 void View::fire_notifications(const std::unordered_set<fqon_t> &changed_objs,
                               order_t t) const {
 	for (auto &obj : changed_objs) {
-		auto it = this->notifiers.find(obj);
+		symbol_t obj_symbol = this->get_symbol(obj);
+		auto it = this->notifiers.find(obj_symbol);
 		if (it != std::end(this->notifiers)) {
 			for (auto &notifier : it->second) {
-				const std::shared_ptr<ObjectState> &obj_state = this->get_raw(obj, t);
+				const std::shared_ptr<ObjectState> &obj_state = this->get_raw(obj_symbol, t);
 				notifier->fire(t, obj, *obj_state);
 			}
 		}
@@ -177,16 +371,14 @@ void View::fire_notifications(const std::unordered_set<fqon_t> &changed_objs,
 
 
 void View::gather_obj_children(std::unordered_set<fqon_t> &target,
-                               const fqon_t &obj,
+                               symbol_t obj,
                                order_t t) const {
 	for (auto &child : this->get_obj_children(obj, t)) {
-		target.insert(child);
-
-		// TODO optimize: maybe it's faster to not recurse
-		//                if that child was already in the set.
-		//                because then all its childs will
-		//                be in there already.
-		this->gather_obj_children(target, child, t);
+		// if the child was already in the set,
+		// all its children are in there as well.
+		if (target.insert(child).second) {
+			this->gather_obj_children(target, this->get_symbol(child), t);
+		}
 	}
 }
 
@@ -196,10 +388,93 @@ StateHistory &View::get_state_history() {
 }
 
 
+std::optional<ValueHolder> View::get_cached_value(symbol_t obj,
+                                                  symbol_t member,
+                                                  order_t t) const {
+	// snapshots are read concurrently, so they have no cache.
+	if (this->frozen) {
+		return std::nullopt;
+	}
+
+	return this->state.get_value(obj, member, t);
+}
+
+
+void View::cache_value(symbol_t obj,
+                       symbol_t member,
+                       order_t t,
+                       const ValueHolder &value) {
+	if (this->frozen) {
+		return;
+	}
+
+	this->state.insert_value(obj, member, t, value);
+}
+
+
+void View::invalidate_values(const std::unordered_set<fqon_t> &objs, order_t t) {
+	for (auto &obj : objs) {
+		this->state.invalidate_values(this->get_symbol(obj), t);
+	}
+}
+
+
 void View::add_child(const std::shared_ptr<View> &view) {
 	view->parent_view = this->shared_from_this();
 	this->children.push_back(view);
 }
 
 
+size_t View::open_transaction() {
+	this->open_transactions.insert(this->commit_count);
+	return this->commit_count;
+}
+
+
+void View::close_transaction(size_t first_commit) {
+	auto it = this->open_transactions.find(first_commit);
+	if (unlikely(it == std::end(this->open_transactions))) {
+		throw InternalError{"closed transaction was not open"};
+	}
+	this->open_transactions.erase(it);
+
+	// commits before the oldest open transaction can't conflict anymore.
+	size_t oldest = this->open_transactions.empty() ? this->commit_count : *std::begin(this->open_transactions);
+	while (not this->commits.empty() and this->commits.front().id < oldest) {
+		this->commits.pop_front();
+	}
+}
+
+
+void View::record_commit(order_t t, std::unordered_set<symbol_t> &&changed) {
+	// the committing transaction is open, so some transaction may care.
+	this->commits.push_back({this->commit_count, t, std::move(changed)});
+	this->commit_count += 1;
+}
+
+
+const commit_record *View::find_conflict(size_t first_commit,
+                                         order_t t,
+                                         const std::unordered_set<symbol_t> &reads) const {
+	for (auto &commit : this->commits) {
+		if (commit.id < first_commit) {
+			continue;
+		}
+
+		// the transaction would drop the later commit's states.
+		if (commit.at > t) {
+			return &commit;
+		}
+
+		for (auto &obj : commit.changed) {
+			if (reads.contains(obj)) {
+				return &commit;
+			}
+		}
+	}
+
+	return nullptr;
+}
+
+
 } // namespace nyan
@@ -1,10 +1,16 @@
 // Copyright 2017-2025 the nyan authors, LGPLv3+. See copying.md for legal info.
 #pragma once
 
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "curve.h"
 #include "object.h"
@@ -23,8 +29,11 @@ class State;
 
 /**
  * Database state view.
+ * Objects can be queried from multiple threads at once,
+ * but not while a transaction of the view is committed.
  */
 class View : public std::enable_shared_from_this<View> {
+	friend class Object;
 	friend class Transaction;
 
 public:
@@ -33,31 +42,102 @@ public:
 	Object get_object(const fqon_t &fqon);
 	const std::shared_ptr<Object> get_object_ptr(const fqon_t &fqon);
 
+	/**
+	 * Get the calculated values of one member for many objects at a given time.
+	 *
+	 * Equivalent to calling Object::get_value() for each object, but
+	 * objects that share ancestors also share their calculation:
+	 * if the linearization of an object continues with the linearization
+	 * of an ancestor, the ancestor value is calculated once and only the
+	 * changes of the objects in front of it are applied on top.
+	 * Objects without own changes then share the value of their ancestor
+	 * during the calculation, each returned value is a copy.
+	 *
+	 * @param objects Identifiers of the objects.
+	 * @param member Identifier of the member.
+	 * @param t Time for which the values are calculated.
+	 *
+	 * @return ValueHolders containing the raw values of the member,
+	 *     in the order of \p objects.
+	 */
+	std::vector<ValueHolder> get_values(std::span<const fqon_t> objects,
+	                                    const memberid_t &member,
+	                                    order_t t = LATEST_T);
+
 	const std::shared_ptr<ObjectState> &get_raw(const fqon_t &fqon, order_t t = LATEST_T) const;
+	const std::shared_ptr<ObjectState> &get_raw(symbol_t obj, order_t t = LATEST_T) const;
+
+	/**
+	 * Get the interned symbol of an object.
+	 * Throws ObjectNotFoundError if the object is not in the database.
+	 */
+	symbol_t get_symbol(const fqon_t &fqon) const;
 
 	const ObjectInfo &get_info(const fqon_t &fqon) const;
 
-	Transaction new_transaction(order_t t = DEFAULT_T);
+	/**
+	 * Create a transaction for this view and its children.
+	 *
+	 * @param t Time at which the transaction is applied.
+	 * @param threads Number of threads that process the views of the transaction.
+	 */
+	Transaction new_transaction(order_t t = DEFAULT_T, size_t threads = 1);
 
 	std::shared_ptr<View> new_child();
 
+	/**
+	 * Create a read-only view with the content of this view at a given time.
+	 * Queries on the snapshot return the content at that time for any
+	 * requested time, and it doesn't see later transactions of this view.
+	 *
+	 * The snapshot can be read from many threads at once without locking,
+	 * while this view continues to commit transactions. It doesn't cache
+	 * the calculated values and it can't have transactions, children
+	 * or notifiers. The object states are shared with this view.
+	 * Commits of this view wait until the snapshot is copied.
+	 * The transitive children of an object are gathered once by the
+	 * first query for it, concurrent queries for the same object wait
+	 * for that.
+	 *
+	 * @param t Time of the content.
+	 *
+	 * @return The new snapshot view.
+	 */
+	std::shared_ptr<View> snapshot(order_t t = LATEST_T);
+
+	/**
+	 * Check if this view is a read-only snapshot.
+	 *
+	 * @return true if the view was created by snapshot(), else false.
+	 */
+	bool is_snapshot() const;
+
 	// TODO: replace by deregistering child when it is destroyed
 	void cleanup_stale_children();
 
 	const Database &get_database() const;
 
 	const std::vector<fqon_t> &get_linearization(const fqon_t &fqon, order_t t = LATEST_T) const;
+	const std::vector<fqon_t> &get_linearization(symbol_t obj, order_t t = LATEST_T) const;
+
+	/**
+	 * Get the precomputed inheritance facts of an object.
+	 */
+	const Lineage &get_lineage(symbol_t obj, order_t t = LATEST_T) const;
 
 	/**
 	 * Get the direct ancestor children of an object.
 	 * Does not step further down than one inheritance level.
 	 */
 	const std::unordered_set<fqon_t> &get_obj_children(const fqon_t &fqon, order_t t = LATEST_T) const;
+	const std::unordered_set<fqon_t> &get_obj_children(symbol_t obj, order_t t = LATEST_T) const;
 
 	/**
 	 * Get all ancestor children of an object including the transitive onces.
+	 * The result is cached, the reference is valid until the next commit.
 	 */
-	std::unordered_set<fqon_t> get_obj_children_all(const fqon_t &fqon, order_t t = LATEST_T) const;
+	const std::unordered_set<fqon_t> &get_obj_children_all(const fqon_t &fqon, order_t t = LATEST_T);
+	const std::unordered_set<fqon_t> &get_obj_children_all(symbol_t obj, order_t t = LATEST_T);
 
 	/**
 	 * Register a function that is called whenever the given object or any of its parents
@@ -89,13 +169,93 @@ protected:
 	const std::vector<std::weak_ptr<View>> &get_children();
 
 	void gather_obj_children(std::unordered_set<fqon_t> &target,
-	                         const fqon_t &obj,
+	                         symbol_t obj,
 	                         order_t t) const;
 
 	StateHistory &get_state_history();
 
+	/**
+	 * Calculate a member value of an object based on the value of the
+	 * ancestor whose linearization it shares, see get_values().
+	 *
+	 * @param obj Symbol of the object.
+	 * @param member Symbol of the member.
+	 * @param t Time for which the value is calculated.
+	 * @param calculated Values calculated so far for the objects and ancestors,
+	 *     nothing for objects without a value. The new values are inserted.
+	 *
+	 * @return Value of the member, or nothing if no parent assigns a value.
+	 */
+	std::optional<ValueHolder> calculate_shared_value(symbol_t obj,
+	                                                  symbol_t member,
+	                                                  order_t t,
+	                                                  std::unordered_map<symbol_t, std::optional<ValueHolder>> *calculated);
+
+	/**
+	 * Get a previously calculated member value of an object.
+	 *
+	 * @return The cached value if it is still valid, else nothing.
+	 */
+	std::optional<ValueHolder> get_cached_value(symbol_t obj,
+	                                            symbol_t member,
+	                                            order_t t) const;
+
+	/**
+	 * Store a calculated member value of an object for later queries.
+	 */
+	void cache_value(symbol_t obj,
+	                 symbol_t member,
+	                 order_t t,
+	                 const ValueHolder &value);
+
+	/**
+	 * Mark the cached values of the given objects as outdated from time t on.
+	 */
+	void invalidate_values(const std::unordered_set<fqon_t> &objs, order_t t);
+
 	void add_child(const std::shared_ptr<View> &view);
 
+	/**
+	 * Register a transaction that was created for this view.
+	 *
+	 * @return Number of transactions committed in this view so far,
+	 *     later commits may conflict with the new transaction.
+	 */
+	size_t open_transaction();
+
+	/**
+	 * Deregister a transaction that was committed or dropped.
+	 * Commits no open transaction can conflict with are forgotten.
+	 *
+	 * @param first_commit Value returned by open_transaction() for it.
+	 */
+	void close_transaction(size_t first_commit);
+
+	/**
+	 * Remember the objects a transaction changed in this view,
+	 * so open transactions can check for conflicts.
+	 *
+	 * @param t Time of the committed transaction.
+	 * @param changed Symbols of the changed objects.
+	 */
+	void record_commit(order_t t, std::unordered_set<symbol_t> &&changed);
+
+	/**
+	 * Find a commit that conflicts with a transaction that is still open:
+	 * a commit for a later time, whose states the transaction would drop,
+	 * or one that changed an object the transaction used at the same
+	 * or an earlier time.
+	 *
+	 * @param first_commit Value returned by open_transaction() for the transaction.
+	 * @param t Time of the transaction.
+	 * @param reads Symbols of the objects the transaction used.
+	 *
+	 * @return The conflicting commit, nullptr if there is none.
+	 */
+	const commit_record *find_conflict(size_t first_commit,
+	                                   order_t t,
+	                                   const std::unordered_set<symbol_t> &reads) const;
+
 	/**
 	 * Database used if the state curve has no information about
 	 * the queried object at all.
@@ -119,13 +279,52 @@ protected:
 	std::weak_ptr<View> parent_view;
 
 	/**
-	 * Registered event notification callbacks.
+	 * Registered event notification callbacks, by object symbol.
+	 */
+	std::unordered_map<symbol_t, std::unordered_set<std::shared_ptr<ObjectNotifierHandle>>> notifiers;
+
+	/**
+	 * Commits that open transactions may conflict with, oldest first.
+	 * Transactions of parent views are recorded as well.
 	 */
-	std::unordered_map<fqon_t, std::unordered_set<std::shared_ptr<ObjectNotifierHandle>>> notifiers;
+	std::deque<commit_record> commits;
 
-	// TODO: track transactions and then use tracking to
-	//       check for transaction modificationconflicts
-	//       beware the child views so that conflicts in them are detected as well
+	/**
+	 * Number of transactions committed in this view.
+	 */
+	size_t commit_count = 0;
+
+	/**
+	 * Commit counts at which the open transactions of this view started.
+	 */
+	std::multiset<size_t> open_transactions;
+
+	/**
+	 * True if this view is a read-only snapshot.
+	 */
+	bool frozen = false;
+
+	/**
+	 * Transitive children of an object in a snapshot.
+	 */
+	struct snapshot_descendants_t {
+		/**
+		 * Set by the first query for the object.
+		 */
+		std::once_flag gathered;
+
+		/**
+		 * All transitive children of the object.
+		 */
+		std::unordered_set<fqon_t> descendants;
+	};
+
+	/**
+	 * Transitive children of each object in a snapshot, by object symbol.
+	 * They're stored here and not in the history,
+	 * so readers of the history need no lock.
+	 */
+	std::vector<snapshot_descendants_t> snapshot_descendants;
 };
 
 } // namespace nyan